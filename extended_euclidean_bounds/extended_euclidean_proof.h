@@ -9,6 +9,7 @@
 #define EXTENDED_EUCLIDEAN_PROOF 1
 
 #include <assert.h>
+#include <stdlib.h>   // abs(), used by the proofs
 #include <limits>
 
 #include "extended_euclidean_collins.h"
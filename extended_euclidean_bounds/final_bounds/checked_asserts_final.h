@@ -0,0 +1,76 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// This file is a copy of essential_asserts_final.h in which every arithmetic
+// operation (other than the division, which can't overflow for a0 >= 0 and
+// a1 > 0) is carried out by the overflow-detecting functions of
+// helpers/checked_arithmetic.h.  Any overflow is tallied in *pCounts under the
+// tag of the operation that overflowed.  The proofs establish that no loop
+// operation overflows, so for every valid input the loop tallies stay zero.
+//
+// Bezout's identity is checked in wrapping arithmetic: the products a*x0 and
+// b*y0 may overflow (their tallies are informational), but since the identity
+// holds exactly, it also holds modulo 2^(bit width of T), and gcd(a,b) is
+// representable in T.
+
+#ifndef CHECKED_ASSERTS_FINAL
+#define CHECKED_ASSERTS_FINAL  1
+
+#ifndef NDEBUG
+#  include "helpers/assert_helper_gcd.h"
+#endif
+#include "helpers/checked_arithmetic.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <limits>
+#include <algorithm>
+
+
+template <typename T>
+void checked_asserts_final(T a, T b, T* pGcd, T* pX, T* pY,
+                           overflow_counts* pCounts)
+{
+   const auto max = static_cast<const T&(*)(const T&, const T&)>(std::max);
+   static_assert(std::numeric_limits<T>::is_integer, "");
+   static_assert(std::numeric_limits<T>::is_signed, "");
+   assert(a >= 0 && b >= 0);    // precondition
+   T x0 = 1, y0 = 0, a0 = a;
+   T x1 = 0, y1 = 1, a1 = b;
+
+   while (a1 != 0) {
+      T q = a0/a1;
+         assert(0 <= q && q <= max(a,b));
+      T qa1 = checked_mul(q, a1, TAG_Q_TIMES_A1, pCounts);
+      T a2 = checked_sub(a0, qa1, TAG_A0_MINUS_QA1, pCounts);
+         assert(0 <= qa1 && qa1 <= max(a,b));
+         assert(0 <= a2 && a2 < max(a,b));
+         if (a2 != 0) assert(q <= max(a,b)/2);
+      T qx1 = checked_mul(q, x1, TAG_Q_TIMES_X1, pCounts);
+      T x2 = checked_sub(x0, qx1, TAG_X0_MINUS_QX1, pCounts);
+         assert(abs(qx1) <= b);
+         assert(abs(x2) <= b);
+         if (a2 != 0) assert(abs(qx1) <= max(1,b/2));
+         if (a2 != 0) assert(abs(x2) <= max(1,b/2));
+      T qy1 = checked_mul(q, y1, TAG_Q_TIMES_Y1, pCounts);
+      T y2 = checked_sub(y0, qy1, TAG_Y0_MINUS_QY1, pCounts);
+         assert(abs(qy1) <= max(1,a));
+         assert(abs(y2) <= max(1,a));
+         if (a2 != 0) assert(abs(qy1) <= max(1,a/2));
+         if (a2 != 0) assert(abs(y2) <= max(1,a/2));
+
+      x0=x1; y0=y1; a0=a1;
+      x1=x2; y1=y2; a1=a2;
+   }
+      assert(a0 == gcd(a,b));
+#ifndef NDEBUG
+      T ax0 = checked_mul(a, x0, TAG_A_TIMES_X0, pCounts);
+      T by0 = checked_mul(b, y0, TAG_B_TIMES_Y0, pCounts);
+      T bezout = checked_add(ax0, by0, TAG_BEZOUT_SUM, pCounts);
+      assert(bezout == gcd(a,b));
+#endif
+   *pX = x0;
+   *pY = y0;
+   *pGcd = a0;
+}
+
+#endif
@@ -0,0 +1,113 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Overflow-detecting arithmetic for the checked version of the proof loop.
+// Each operation computes its result with a GCC/Clang overflow builtin, which
+// evaluates the operation in infinite precision and reports whether the exact
+// result fits in T.  The (wrapped) result is returned, and the overflow is
+// counted under the tag that names the operation.  This lets the loop run at
+// the native width of T, so that an overflow can't be hidden by integer
+// promotion (int8_t, int16_t) or by testing with a wider type than needed.
+
+#ifndef EXTENDED_EUCLIDEAN_PROOF_CHECKED_ARITHMETIC
+#define EXTENDED_EUCLIDEAN_PROOF_CHECKED_ARITHMETIC 1
+
+#include <cstdint>
+
+#if !defined(__GNUC__) && !defined(__clang__)
+#  error "checked_arithmetic.h requires __builtin_mul_overflow and __builtin_sub_overflow"
+#endif
+
+
+// One tag per arithmetic operation of the Extended Euclidean algorithm.  The
+// tags up to and including TAG_Y0_MINUS_QY1 are the loop operations, which
+// the proofs show never overflow.  The remaining tags are the operations of
+// the final check of Bezout's identity, a*x0 + b*y0 == gcd(a,b).  The proofs
+// bound x0 and y0 but not the products a*x0 and b*y0, which can exceed T (by
+// up to roughly a factor of max(a,b)/2) even though their sum is gcd(a,b).
+enum overflow_tag {
+   TAG_Q_TIMES_A1,        // q*a1
+   TAG_A0_MINUS_QA1,      // a0 - q*a1
+   TAG_Q_TIMES_X1,        // q*x1
+   TAG_X0_MINUS_QX1,      // x0 - q*x1
+   TAG_Q_TIMES_Y1,        // q*y1
+   TAG_Y0_MINUS_QY1,      // y0 - q*y1
+   TAG_A_TIMES_X0,        // a*x0
+   TAG_B_TIMES_Y0,        // b*y0
+   TAG_BEZOUT_SUM,        // a*x0 + b*y0
+   NUM_OVERFLOW_TAGS
+};
+
+constexpr int NUM_LOOP_OVERFLOW_TAGS = TAG_Y0_MINUS_QY1 + 1;
+
+inline const char* overflow_tag_name(overflow_tag tag)
+{
+   switch (tag) {
+      case TAG_Q_TIMES_A1:    return "q*a1";
+      case TAG_A0_MINUS_QA1:  return "a0 - q*a1";
+      case TAG_Q_TIMES_X1:    return "q*x1";
+      case TAG_X0_MINUS_QX1:  return "x0 - q*x1";
+      case TAG_Q_TIMES_Y1:    return "q*y1";
+      case TAG_Y0_MINUS_QY1:  return "y0 - q*y1";
+      case TAG_A_TIMES_X0:    return "a*x0";
+      case TAG_B_TIMES_Y0:    return "b*y0";
+      case TAG_BEZOUT_SUM:    return "a*x0 + b*y0";
+      default:                return "unknown";
+   }
+}
+
+
+// Per-tag tallies.  operations[tag] counts every execution of the operation,
+// overflows[tag] counts the executions whose exact result didn't fit in T.
+struct overflow_counts {
+   uint64_t operations[NUM_OVERFLOW_TAGS] = {};
+   uint64_t overflows[NUM_OVERFLOW_TAGS] = {};
+
+   uint64_t loop_overflows() const
+   {
+      uint64_t total = 0;
+      for (int i = 0; i < NUM_LOOP_OVERFLOW_TAGS; ++i)
+         total += overflows[i];
+      return total;
+   }
+   void add(const overflow_counts& other)
+   {
+      for (int i = 0; i < NUM_OVERFLOW_TAGS; ++i) {
+         operations[i] += other.operations[i];
+         overflows[i] += other.overflows[i];
+      }
+   }
+};
+
+
+template <typename T>
+T checked_mul(T u, T v, overflow_tag tag, overflow_counts* pCounts)
+{
+   T result;
+   if (__builtin_mul_overflow(u, v, &result))
+      ++pCounts->overflows[tag];
+   ++pCounts->operations[tag];
+   return result;
+}
+
+template <typename T>
+T checked_sub(T u, T v, overflow_tag tag, overflow_counts* pCounts)
+{
+   T result;
+   if (__builtin_sub_overflow(u, v, &result))
+      ++pCounts->overflows[tag];
+   ++pCounts->operations[tag];
+   return result;
+}
+
+template <typename T>
+T checked_add(T u, T v, overflow_tag tag, overflow_counts* pCounts)
+{
+   T result;
+   if (__builtin_add_overflow(u, v, &result))
+      ++pCounts->overflows[tag];
+   ++pCounts->operations[tag];
+   return result;
+}
+
+#endif
@@ -0,0 +1,84 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// A helper for the exhaustive test drivers: calls row_function(row) for every
+// row in [rowBegin, rowEnd) on numThreads threads, and meanwhile reports the
+// progress and throughput from the calling thread.  Rows are handed out one
+// at a time from an atomic counter, so threads stay balanced even though the
+// cost of a row varies.  row_function(row) returns the number of (a, b) pairs
+// it tested, which is used only for the throughput report.
+
+#ifndef EXTENDED_EUCLIDEAN_PROOF_PARALLEL_SWEEP
+#define EXTENDED_EUCLIDEAN_PROOF_PARALLEL_SWEEP 1
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+template <class RowFunction>
+uint64_t parallel_sweep(int64_t rowBegin, int64_t rowEnd,
+                        unsigned int numThreads, RowFunction row_function,
+                        double reportIntervalSeconds = 10.0)
+{
+   if (numThreads == 0)
+      numThreads = 1;
+   std::atomic<int64_t> nextRow(rowBegin);
+   std::atomic<int64_t> rowsDone(0);
+   std::atomic<uint64_t> pairsDone(0);
+   std::atomic<unsigned int> threadsRunning(numThreads);
+   std::mutex mutex;
+   std::condition_variable finished;
+
+   auto worker = [&]() {
+      for (int64_t row = nextRow++; row < rowEnd; row = nextRow++) {
+         pairsDone += row_function(row);
+         ++rowsDone;
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--threadsRunning == 0)
+         finished.notify_all();
+   };
+
+   auto start = std::chrono::steady_clock::now();
+   std::vector<std::thread> threads;
+   for (unsigned int t = 0; t < numThreads; ++t)
+      threads.emplace_back(worker);
+
+   const int64_t totalRows = rowEnd - rowBegin;
+   std::unique_lock<std::mutex> lock(mutex);
+   while (!finished.wait_for(lock,
+                   std::chrono::duration<double>(reportIntervalSeconds),
+                   [&]() { return threadsRunning == 0; })) {
+      double elapsed = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start).count();
+      int64_t rows = rowsDone;
+      uint64_t pairs = pairsDone;
+      std::cout << "   " << rows << "/" << totalRows << " rows ("
+                << std::fixed << std::setprecision(1)
+                << 100.0 * static_cast<double>(rows) / totalRows << "%), "
+                << pairs << " pairs, "
+                << std::setprecision(0) << pairs / elapsed << " pairs/s\n"
+                << std::defaultfloat << std::flush;
+   }
+   lock.unlock();
+   for (auto& thread : threads)
+      thread.join();
+
+   double elapsed = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start).count();
+   uint64_t pairs = pairsDone;
+   std::cout << "   " << pairs << " pairs in " << std::fixed
+             << std::setprecision(1) << elapsed << " s ("
+             << std::setprecision(0) << pairs / elapsed << " pairs/s on "
+             << numThreads << " thread(s))\n" << std::defaultfloat;
+   return pairs;
+}
+
+#endif
@@ -0,0 +1,145 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Runs the checked version of the final algorithm (checked_asserts_final.h)
+// at the native widths int8_t, int16_t, int32_t and int64_t, and reports how
+// many times each tagged operation overflowed.  The test fails if any loop
+// operation overflows.  Pass --full16 to also sweep every non-negative int16_t
+// pair (about 2^30 pairs).
+
+
+// Force NDEBUG to be undefined, since testing of the proofs requires assert().
+#ifdef NDEBUG
+#  undef NDEBUG
+#endif
+
+
+#include "final_bounds/checked_asserts_final.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+
+template <typename T>
+void checked_test(int64_t a, int64_t b, overflow_counts* pCounts)
+{
+   T gcd, x, y;
+   checked_asserts_final(static_cast<T>(a), static_cast<T>(b),
+                         &gcd, &x, &y, pCounts);
+}
+
+
+// test all combinations of a and b such that 0 <= a <= max and 0 <= b <= max
+template <typename T>
+void checked_exhaustive_tests(int64_t max, overflow_counts* pCounts)
+{
+   for (int64_t a = 0; a <= max; ++a) {
+       for (int64_t b = 0; b <= max; ++b)
+           checked_test<T>(a, b, pCounts);
+   }
+}
+
+
+// test large combinations of a and b where a and b are very large or small
+template <typename T>
+void checked_large_combination_tests(int64_t max, overflow_counts* pCounts)
+{
+   for (int64_t a = 0; a < 5; ++a) {
+       for (int64_t b = max; b >= 0; --b)
+           checked_test<T>(a, b, pCounts);
+   }
+   for (int64_t a = max; a >= max - 5; --a) {
+       for (int64_t b = max; b >= 0; --b)
+           checked_test<T>(a, b, pCounts);
+   }
+   for (int64_t b = max; b >= 0; --b)
+       checked_test<T>(max / 2, b, pCounts);
+
+   for (int64_t a = max; a >= 0; --a) {
+       for (int64_t b = 0; b < 5; ++b)
+           checked_test<T>(a, b, pCounts);
+   }
+   for (int64_t a = max; a >= 0; --a) {
+       for (int64_t b = max; b >= max - 5; --b)
+           checked_test<T>(a, b, pCounts);
+   }
+   for (int64_t a = max; a >= 0; --a)
+       checked_test<T>(a, max / 2, pCounts);
+}
+
+
+// test combinations of a and b where a and b are extremely large or small
+template <typename T>
+void checked_extreme_value_tests(overflow_counts* pCounts)
+{
+   constexpr int64_t max = std::numeric_limits<T>::max();
+   const int64_t edges[] = { 0, 1, 2, 3, 4, 5, max/2 - 1, max/2, max/2 + 1,
+                             max - 5, max - 4, max - 3, max - 2, max - 1, max };
+   for (int64_t a : edges) {
+       for (int64_t b : edges)
+           checked_test<T>(a, b, pCounts);
+   }
+}
+
+
+int report(const char* typeName, const overflow_counts& counts)
+{
+   std::cout << "  " << typeName << ":\n";
+   for (int i = 0; i < NUM_OVERFLOW_TAGS; ++i) {
+       overflow_tag tag = static_cast<overflow_tag>(i);
+       std::cout << "    " << std::left << std::setw(14)
+                 << overflow_tag_name(tag) << std::right
+                 << std::setw(12) << counts.overflows[i] << " overflows in "
+                 << std::setw(12) << counts.operations[i] << " operations"
+                 << (i < NUM_LOOP_OVERFLOW_TAGS ? "" : "  (informational)")
+                 << "\n";
+   }
+   if (counts.loop_overflows() != 0) {
+       std::cout << "test failed: a loop operation overflowed " << typeName
+                 << "\n";
+       return 1;
+   }
+   return 0;
+}
+
+
+template <typename T>
+int checked_width_tests(const char* typeName, bool full)
+{
+   constexpr int64_t max = std::numeric_limits<T>::max();
+   overflow_counts counts;
+   if (full || max <= 255) {
+       checked_exhaustive_tests<T>(max, &counts);
+   } else {
+       checked_exhaustive_tests<T>(255, &counts);
+       checked_large_combination_tests<T>(max < 65535 ? max : 65535, &counts);
+   }
+   checked_extreme_value_tests<T>(&counts);
+   return report(typeName, counts);
+}
+
+
+int main(int argc, char *argv[])
+{
+   std::cout << "***Test Checked Arithmetic at Native Type Widths***\n\n";
+
+   bool full16 = false;
+   for (int i = 1; i < argc; ++i) {
+       if (std::strcmp(argv[i], "--full16") == 0)
+           full16 = true;
+   }
+
+   if (checked_width_tests<int8_t>("int8_t", true) != 0)
+       return 1;
+   if (checked_width_tests<int16_t>("int16_t", full16) != 0)
+       return 1;
+   if (checked_width_tests<int32_t>("int32_t", false) != 0)
+       return 1;
+   if (checked_width_tests<int64_t>("int64_t", false) != 0)
+       return 1;
+
+   std::cout << "\n*** Passed all tests ***\n";
+   return 0;
+}
@@ -0,0 +1,284 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Runs extended_euclidean_proof<T>() at the native widths T = int8_t and
+// T = int16_t, over every pair 0 <= a <= max(T) and 0 <= b <= max(T).  At
+// these widths the bounds of the proofs are what keeps the algorithm from
+// overflowing, so passing gives an exhaustive guarantee for the full domain.
+// The int16_t sweep is about 2^30 pairs; it runs on all hardware threads and
+// reports its progress and throughput.  The full sweep also checks that
+// unrolled_extended_euclidean<STEPS>() of unsigned_inputs/, for 2 and 4 steps,
+// returns the proof's results on every pair.
+//
+// Usage: test_exhaustive_native_width [--width 8|16] [--threads N]
+//                                     [--rows BEGIN END]
+//                                     [--reduced [--sample N]]
+// --rows restricts the int16_t sweep to BEGIN <= a < END, so that the sweep
+// can be split across separate runs.  It can't be combined with --reduced.
+//
+// --reduced covers the same domain, but runs the proofs only on canonical
+// representatives: the coprime pairs with a >= b.  Every other pair is
+// (k*a, k*b) or (k*b, k*a) for a canonical (a, b) and k >= 1, and its result
+// follows from the canonical result without running the algorithm:
+//  - scaling both inputs by k scales every remainder by k and leaves every
+//    quotient (and so every x and y) unchanged, giving (k*gcd, x, y);
+//  - for b < a, the first iteration on (b, a) has q == 0 and just swaps the
+//    inputs along with the roles of x and y, giving (gcd, y, x).
+// Because the quotients, x's and y's of a derived pair are those of its
+// canonical pair, and every bound of the proofs is nondecreasing in a and b,
+// the canonical pair's proof establishes all the bounds for the derived pair.
+// Each derived result is still checked against the final bounds, and one in
+// every N derived pairs (default 64, selected by a hash of the pair) is run
+// through the proofs directly and compared to its derived result.
+
+
+// Force NDEBUG to be undefined, since testing of the proofs requires assert().
+#ifdef NDEBUG
+#  undef NDEBUG
+#endif
+
+
+#include "extended_euclidean_proof.h"
+#include "helpers/parallel_sweep.h"
+#include "unsigned_inputs/unrolled_extended_euclidean.h"
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <type_traits>
+
+
+// The pair each thread is testing, so that a failed assert can report it.
+thread_local int64_t g_currentA = -1;
+thread_local int64_t g_currentB = -1;
+
+extern "C" void report_failed_pair(int)
+{
+   if (g_currentA >= 0)
+       std::fprintf(stderr, "test failed: a == %lld, b == %lld\n",
+                    static_cast<long long>(g_currentA),
+                    static_cast<long long>(g_currentB));
+   std::signal(SIGABRT, SIG_DFL);
+   std::abort();
+}
+
+
+template <typename T>
+uint64_t exhaustive_row(int64_t a)
+{
+   using U = typename std::make_unsigned<T>::type;
+   constexpr int64_t max = std::numeric_limits<T>::max();
+   T gcd, x, y;
+   U gcd2, gcd4;
+   T x2, y2, x4, y4;
+   g_currentA = a;
+   for (int64_t b = 0; b <= max; ++b) {
+       g_currentB = b;
+       extended_euclidean_proof(static_cast<T>(a), static_cast<T>(b),
+                                &gcd, &x, &y);
+       unrolled_extended_euclidean<2, T, U>(static_cast<U>(a),
+                         static_cast<U>(b), &gcd2, &x2, &y2);
+       assert(gcd2 == static_cast<U>(gcd) && x2 == x && y2 == y);
+       unrolled_extended_euclidean<4, T, U>(static_cast<U>(a),
+                         static_cast<U>(b), &gcd4, &x4, &y4);
+       assert(gcd4 == static_cast<U>(gcd) && x4 == x && y4 == y);
+   }
+   return static_cast<uint64_t>(max + 1);
+}
+
+
+inline int64_t small_gcd(int64_t a, int64_t b)
+{
+   while (b != 0) {
+       int64_t t = a % b;
+       a = b;
+       b = t;
+   }
+   return a;
+}
+
+
+inline bool is_sampled(int64_t a, int64_t b, uint64_t sampleMask)
+{
+   uint64_t h = static_cast<uint64_t>(a) * 0x9E3779B97F4A7C15u
+                ^ static_cast<uint64_t>(b) * 0xC2B2AE3D27D4EB4Fu;
+   h ^= h >> 29;
+   h *= 0xBF58476D1CE4E5B9u;
+   h ^= h >> 32;
+   return (h & sampleMask) == 0;
+}
+
+
+std::atomic<uint64_t> g_sampledPairs(0);
+
+// Checks the derived result (gcd, x, y) for the pair (a, b) against the final
+// bounds, and for a sampled fraction of pairs against the proofs themselves.
+template <typename T>
+void check_derived(int64_t a, int64_t b, int64_t gcd, int64_t x, int64_t y,
+                   uint64_t sampleMask)
+{
+   const auto max = static_cast<const int64_t&(*)(const int64_t&,
+                                                  const int64_t&)>(std::max);
+   g_currentA = a;
+   g_currentB = b;
+   assert(a*x + b*y == gcd);
+   assert(llabs(x) <= max(1,b/2));
+   assert(llabs(y) <= max(1,a/2));
+   assert(x == 1 || llabs(x) <= (b/gcd)/2);
+   assert(y == 1 || llabs(y) <= (a/gcd)/2);
+   if (is_sampled(a, b, sampleMask)) {
+       T gcd2, x2, y2;
+       extended_euclidean_proof(static_cast<T>(a), static_cast<T>(b),
+                                &gcd2, &x2, &y2);
+       assert(gcd2 == gcd && x2 == x && y2 == y);
+       ++g_sampledPairs;
+   }
+}
+
+
+// Tests the canonical pairs (a, b) with 0 <= b <= a and gcd(a,b) == 1, and
+// every pair derived from them.  Returns the number of pairs covered.
+template <typename T>
+uint64_t reduced_row(int64_t a, uint64_t sampleMask)
+{
+   constexpr int64_t max = std::numeric_limits<T>::max();
+   uint64_t covered = 0;
+   for (int64_t b = 0; b <= a; ++b) {
+       if (small_gcd(a, b) != 1)
+           continue;
+       T gcd, x, y;
+       g_currentA = a;
+       g_currentB = b;
+       extended_euclidean_proof(static_cast<T>(a), static_cast<T>(b),
+                                &gcd, &x, &y);
+       assert(gcd == 1);
+       ++covered;
+       for (int64_t k = 1; k <= max / a; ++k) {
+           if (k > 1) {
+               check_derived<T>(k*a, k*b, k, x, y, sampleMask);
+               ++covered;
+           }
+           if (b < a) {
+               check_derived<T>(k*b, k*a, k, y, x, sampleMask);
+               ++covered;
+           }
+       }
+   }
+   return covered;
+}
+
+
+template <typename T>
+void reduced_native_width_tests(const char* typeName, unsigned int numThreads,
+                                uint64_t sampleRate)
+{
+   constexpr int64_t max = std::numeric_limits<T>::max();
+   std::cout << "Testing " << typeName << " for all values 0 <= a <= " << max
+             << " with 0 <= b <= " << max << ", reduced to canonical pairs "
+             << "(sampling 1 in " << sampleRate << " derived pairs):\n";
+   g_sampledPairs = 0;
+   uint64_t covered = parallel_sweep(1, max + 1, numThreads,
+                  [sampleRate](int64_t a) {
+                      return reduced_row<T>(a, sampleRate - 1);
+                  });
+   // the pair (0, 0) is the only one not derived from a canonical pair
+   T gcd, x, y;
+   extended_euclidean_proof(static_cast<T>(0), static_cast<T>(0),
+                            &gcd, &x, &y);
+   ++covered;
+   // every pair of the domain is derived from exactly one canonical pair
+   assert(covered == static_cast<uint64_t>((max + 1) * (max + 1)));
+   std::cout << "   covered " << covered << " pairs, of which "
+             << g_sampledPairs << " derived pairs were also tested directly\n"
+             << "Passed reduced exhaustive " << typeName << " tests.\n";
+}
+
+
+template <typename T>
+void exhaustive_native_width_tests(const char* typeName, int64_t rowBegin,
+                                   int64_t rowEnd, unsigned int numThreads)
+{
+   std::cout << "Testing " << typeName << " for all values " << rowBegin
+             << " <= a < " << rowEnd << " with 0 <= b <= "
+             << +std::numeric_limits<T>::max() << ":\n";
+   parallel_sweep(rowBegin, rowEnd, numThreads, exhaustive_row<T>);
+   std::cout << "Passed exhaustive " << typeName << " tests.\n";
+}
+
+
+int main(int argc, char *argv[])
+{
+   std::cout << "***Test Extended Euclidean Bounds Proof at Native Widths***\n\n";
+
+   int width = 0;   // 0 means both widths
+   unsigned int numThreads = std::thread::hardware_concurrency();
+   int64_t rowBegin = 0;
+   int64_t rowEnd = static_cast<int64_t>(std::numeric_limits<int16_t>::max()) + 1;
+   bool rowsGiven = false;
+   bool reduced = false;
+   uint64_t sampleRate = 64;
+   for (int i = 1; i < argc; ++i) {
+       if (std::strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+           width = std::atoi(argv[++i]);
+       } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+           numThreads = static_cast<unsigned int>(std::atoi(argv[++i]));
+       } else if (std::strcmp(argv[i], "--rows") == 0 && i + 2 < argc) {
+           rowBegin = std::atoll(argv[++i]);
+           rowEnd = std::atoll(argv[++i]);
+           rowsGiven = true;
+       } else if (std::strcmp(argv[i], "--reduced") == 0) {
+           reduced = true;
+       } else if (std::strcmp(argv[i], "--sample") == 0 && i + 1 < argc) {
+           sampleRate = std::strtoull(argv[++i], nullptr, 10);
+       } else {
+           std::cout << "unknown or incomplete option: " << argv[i] << "\n";
+           return 1;
+       }
+   }
+   if (width != 0 && width != 8 && width != 16) {
+       std::cout << "--width must be 8 or 16\n";
+       return 1;
+   }
+   if (rowsGiven && reduced) {
+       std::cout << "--rows can't be combined with --reduced\n";
+       return 1;
+   }
+   if (sampleRate == 0 || (sampleRate & (sampleRate - 1)) != 0) {
+       std::cout << "--sample must be a power of two\n";
+       return 1;
+   }
+   std::signal(SIGABRT, report_failed_pair);
+
+   if (reduced) {
+       if (width == 0 || width == 8)
+           reduced_native_width_tests<int8_t>("int8_t", numThreads, sampleRate);
+       if (width == 0 || width == 16)
+           reduced_native_width_tests<int16_t>("int16_t", numThreads, sampleRate);
+       std::cout << "\n*** Passed all tests ***\n";
+       return 0;
+   }
+
+   if (width == 0 || width == 8) {
+       constexpr int64_t max8 = std::numeric_limits<int8_t>::max();
+       exhaustive_native_width_tests<int8_t>("int8_t", 0, max8 + 1, numThreads);
+   }
+   if (width == 0 || width == 16) {
+       constexpr int64_t max16 = std::numeric_limits<int16_t>::max();
+       if (rowBegin < 0 || rowEnd > max16 + 1 || rowBegin >= rowEnd) {
+           std::cout << "--rows must satisfy 0 <= BEGIN < END <= " << max16 + 1
+                     << "\n";
+           return 1;
+       }
+       exhaustive_native_width_tests<int16_t>("int16_t", rowBegin, rowEnd,
+                                              numThreads);
+   }
+
+   std::cout << "\n*** Passed all tests ***\n";
+   return 0;
+}
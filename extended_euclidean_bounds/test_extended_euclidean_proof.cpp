@@ -9,6 +9,7 @@
 
 
 #include "extended_euclidean_proof.h"
+#include "unsigned_inputs/input_generators.h"
 #include <iostream>
 #include <cstdint>
 #include <limits>
@@ -101,6 +102,15 @@ int main(int argc, char *argv[])
    std::cout << "Passed extremely large value tests.\n";
 
 
+   // test inputs structured to stress the algorithm (Fibonacci pairs, huge
+   // quotients, large gcds, values near powers of two, scaled pairs)
+   adversarial_pairs<T> adversarial;
+   while (adversarial.next(&a, &b))
+       extended_euclidean_proof(a, b, &gcd, &x, &y);
+
+   std::cout << "Passed adversarial input tests.\n";
+
+
    std::cout << "\n*** Passed all tests ***\n";
    return 0;
 }
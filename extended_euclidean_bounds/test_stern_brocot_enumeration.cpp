@@ -0,0 +1,206 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Verifies unsigned_extended_euclidean() and essential_asserts_final() over
+// every pair 0 <= a, b <= N, deriving each expected result in O(1) time by a
+// depth-first walk of the Stern-Brocot tree instead of running a reference
+// implementation.
+//
+// Every fraction a/b with a, b >= 1 and gcd(a,b) == 1 appears exactly once in
+// the Stern-Brocot tree, as the mediant (pL+pR)/(qL+qR) of its two boundary
+// fractions pL/qL < a/b < pR/qR, where pR*qL - pL*qR == 1.  The left child
+// of a/b is the mediant of pL/qL and a/b, and its right child is the mediant
+// of a/b and pR/qR, so each node is derived from its parent in O(1) time.
+// Since a == pL+pR and b == qL+qR,
+//    a*qL - b*pL == 1    and    b*pR - a*qR == 1,
+// so (qL, -pL) and (-qR, pR) both solve a*x + b*y == 1.  They are the only
+// solutions with abs(x) <= b, and the Extended Euclidean algorithm returns
+// the one with abs(x) <= max(1,b/2) (see final_bounds.h): the boundary with
+// the smaller denominator.  The denominators tie only for b == 2, where the
+// algorithm returns x == 1 from the left boundary.  (In continued fraction
+// terms, the chosen boundary is the second-to-last convergent of a/b.)
+//
+// All other pairs follow from the coprime ones: (k*a, k*b) has the result
+// (k, x, y) of (a, b), the pairs (k, 0) and (0, k) are multiples of (1, 0) and
+// (0, 1), and (0, 0) has the result (0, 1, 0).
+//
+// Usage: test_stern_brocot_enumeration [--width 8|16|32] [--max N]
+
+
+// Force NDEBUG to be undefined, since testing of the proofs requires assert().
+#ifdef NDEBUG
+#  undef NDEBUG
+#endif
+
+
+#include <stdlib.h>   // abs(), used by essential_asserts_final()
+#include "final_bounds/essential_asserts_final.h"
+#include "unsigned_inputs/unsigned_extended_euclidean.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+
+// U is the unsigned input type of unsigned_extended_euclidean, and T is a
+// signed type that can represent every value of U, for essential_asserts_final
+template <class U, class T>
+class stern_brocot_verifier {
+   using S = typename std::make_signed<U>::type;
+   uint64_t max;
+   uint64_t pairsTested;
+
+   struct node {
+      uint64_t pL, qL, pR, qR;   // the boundary fractions pL/qL and pR/qR
+   };
+public:
+   explicit stern_brocot_verifier(uint64_t max) : max(max), pairsTested(0) {}
+
+   uint64_t pairs_tested() const { return pairsTested; }
+
+   // Tests (a, b) against the expected results.  Returns 0 on success.
+   int test_pair(uint64_t a, uint64_t b, uint64_t gcd, int64_t x, int64_t y)
+   {
+      ++pairsTested;
+      U gcd1;
+      S x1, y1;
+      unsigned_extended_euclidean(static_cast<U>(a), static_cast<U>(b),
+                                  &gcd1, &x1, &y1);
+      T gcd2, x2, y2;
+      essential_asserts_final(static_cast<T>(a), static_cast<T>(b),
+                              &gcd2, &x2, &y2);
+      if (gcd1 != gcd || x1 != x || y1 != y ||
+              gcd2 != static_cast<T>(gcd) || x2 != x || y2 != y) {
+          std::cout << "test failed: a == " << a << ", b == " << b << "\n"
+                    << "   expected gcd == " << gcd << ", x == " << x
+                    << ", y == " << y << "\n"
+                    << "   unsigned_extended_euclidean: gcd == " << +gcd1
+                    << ", x == " << +x1 << ", y == " << +y1 << "\n"
+                    << "   essential_asserts_final: gcd == "
+                    << static_cast<int64_t>(gcd2) << ", x == "
+                    << static_cast<int64_t>(x2) << ", y == "
+                    << static_cast<int64_t>(y2) << "\n";
+          return 1;
+      }
+      return 0;
+   }
+
+   // Tests the coprime pair (a, b) and all of its multiples (k*a, k*b).
+   int test_multiples(uint64_t a, uint64_t b, int64_t x, int64_t y)
+   {
+      uint64_t largest = (a > b) ? a : b;
+      for (uint64_t k = 1; k <= max / largest; ++k) {
+          if (test_pair(k*a, k*b, k, x, y) != 0)
+              return 1;
+      }
+      return 0;
+   }
+
+   int run()
+   {
+      if (test_pair(0, 0, 0, 1, 0) != 0)
+          return 1;
+      if (test_multiples(1, 0, 1, 0) != 0 || test_multiples(0, 1, 0, 1) != 0)
+          return 1;
+      if (max == 0)
+          return 0;
+
+      // depth-first walk, starting at the root 1/1 between 0/1 and 1/0
+      std::vector<node> stack;
+      stack.push_back(node{0, 1, 1, 0});
+      while (!stack.empty()) {
+          node n = stack.back();
+          stack.pop_back();
+          uint64_t a = n.pL + n.pR;
+          uint64_t b = n.qL + n.qR;
+          int64_t x, y;
+          if (n.qL <= n.qR) {
+              x = static_cast<int64_t>(n.qL);
+              y = -static_cast<int64_t>(n.pL);
+          } else {
+              x = -static_cast<int64_t>(n.qR);
+              y = static_cast<int64_t>(n.pR);
+          }
+          if (test_multiples(a, b, x, y) != 0)
+              return 1;
+          // the children's numerators and denominators are both >= a and b
+          if (a + n.pR <= max && b + n.qR <= max)
+              stack.push_back(node{a, b, n.pR, n.qR});      // right child
+          if (n.pL + a <= max && n.qL + b <= max)
+              stack.push_back(node{n.pL, n.qL, a, b});      // left child
+      }
+      return 0;
+   }
+};
+
+
+template <class U, class T>
+int stern_brocot_tests(const char* typeName, uint64_t max)
+{
+   static_assert(std::numeric_limits<T>::max() >= std::numeric_limits<U>::max(), "");
+   if (max > std::numeric_limits<U>::max()) {
+       std::cout << "--max must be at most " << +std::numeric_limits<U>::max()
+                 << " for " << typeName << "\n";
+       return 1;
+   }
+   std::cout << "Testing " << typeName << " for all values 0 <= a <= " << max
+             << " with 0 <= b <= " << max << ":\n";
+   auto start = std::chrono::steady_clock::now();
+   stern_brocot_verifier<U, T> verifier(max);
+   if (verifier.run() != 0)
+       return 1;
+   double elapsed = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start).count();
+   uint64_t pairs = verifier.pairs_tested();
+   if (pairs != (max + 1) * (max + 1)) {
+       std::cout << "test failed: the walk covered " << pairs << " pairs\n";
+       return 1;
+   }
+   std::cout << "   " << pairs << " pairs in " << elapsed << " s ("
+             << static_cast<uint64_t>(pairs / elapsed) << " pairs/s)\n"
+             << "Passed Stern-Brocot enumeration tests.\n";
+   return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+   std::cout << "***Test Extended Euclidean by Stern-Brocot Enumeration***\n\n";
+
+   int width = 16;
+   uint64_t max = 1000;
+   bool maxGiven = false;
+   for (int i = 1; i < argc; ++i) {
+       if (std::strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+           width = std::atoi(argv[++i]);
+       } else if (std::strcmp(argv[i], "--max") == 0 && i + 1 < argc) {
+           max = std::strtoull(argv[++i], nullptr, 10);
+           maxGiven = true;
+       } else {
+           std::cout << "unknown or incomplete option: " << argv[i] << "\n";
+           return 1;
+       }
+   }
+
+   int result;
+   if (width == 8)
+       result = stern_brocot_tests<uint8_t, int16_t>("uint8_t",
+                                                     maxGiven ? max : 255);
+   else if (width == 16)
+       result = stern_brocot_tests<uint16_t, int32_t>("uint16_t", max);
+   else if (width == 32)
+       result = stern_brocot_tests<uint32_t, int64_t>("uint32_t", max);
+   else {
+       std::cout << "--width must be 8, 16 or 32\n";
+       return 1;
+   }
+   if (result != 0)
+       return 1;
+
+   std::cout << "\n*** Passed all tests ***\n";
+   return 0;
+}
@@ -0,0 +1,210 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Compares all the engines on the same batches: the median ns per call over
+// --runs timed runs, and per call hardware counts from perf_counters.h:
+// cycles, instructions, IPC, branch misses and the mispredict rate (misses
+// per branch), and the fraction of cycles with the divider active.  Counters
+// the host doesn't provide are shown as "-".
+//
+// The engines are registered in benchmark_engines(); register new engines
+// there.  signed_extended_euclidean() requires inputs that fit the signed
+// type, so every engine is run on inputs with the top bit cleared.
+//
+// With --json FILE, also writes every run's ns per call, the counters and
+// the host fingerprint in the format of bench_json.h, as a baseline for
+// tools/bench_compare.
+//
+// Usage: bench_engines [--n PAIRS] [--width 16|32|64] [--runs R]
+//                      [--dist uniform|random_length|adversarial]
+//                      [--json FILE]
+
+#include "bench_harness.h"
+#include "bench_json.h"
+#include "perf_counters.h"
+#include "../extended_euclidean_autotune.h"
+#include "../extended_euclidean_dispatch.h"
+#include "../signed_extended_euclidean.h"
+#include "../unsigned_extended_euclidean.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+
+template <class S, class U>
+void signed_engine_batch(const U* a, const U* b, std::size_t n,
+                         U* pGcd, S* pX, S* pY)
+{
+   for (std::size_t i = 0; i < n; ++i) {
+      S gcd;
+      signed_extended_euclidean<S>(static_cast<S>(a[i]), static_cast<S>(b[i]),
+                                   &gcd, &pX[i], &pY[i]);
+      pGcd[i] = static_cast<U>(gcd);
+   }
+}
+
+
+// every engine for this width that the host can run, as batch kernels
+template <class S, class U>
+std::vector<batch_kernel<S, U>> benchmark_engines()
+{
+   std::vector<batch_kernel<S, U>> engines = {
+      { "signed", &signed_engine_batch<S, U> },
+      { "unsigned", &scalar_extended_euclidean<S, U> },
+   };
+   for (const scalar_engine<S, U>& engine : scalar_engines<S, U>()) {
+      if (std::strcmp(engine.name, "plain") != 0)
+         engines.push_back({ engine.name, engine.batch });
+   }
+   for (const batch_kernel<S, U>& kernel :
+                              supported_kernels<S, U>(host_cpu_features())) {
+      if (std::strcmp(kernel.name, "scalar") != 0)
+         engines.push_back(kernel);
+   }
+   engines.push_back({ "dispatched", &dispatched_extended_euclidean<S, U> });
+   engines.push_back({ "tuned", &tuned_extended_euclidean_batch<S, U> });
+   return engines;
+}
+
+
+void print_header()
+{
+   std::cout << std::left << std::setw(10) << "type" << std::setw(15) << "dist"
+             << std::setw(14) << "engine" << std::right << std::setw(9) << "ns"
+             << std::setw(9) << "cycles" << std::setw(9) << "instr"
+             << std::setw(7) << "IPC" << std::setw(9) << "br-miss"
+             << std::setw(8) << "miss%" << std::setw(7) << "div%" << "\n";
+}
+
+// a counter column, or "-" if the counter is unavailable
+void print_count(double value, int width, int precision)
+{
+   if (value < 0)
+      std::cout << std::setw(width) << "-";
+   else
+      std::cout << std::setw(width) << std::setprecision(precision) << value;
+}
+
+
+template <class U>
+void bench_width(const char* typeName, bench_distribution dist, std::size_t n,
+                 int runs, perf_counters& counters, bench_json_file* pJson)
+{
+   using S = typename std::make_signed<U>::type;
+   std::vector<U> a, b, gcd(n);
+   std::vector<S> x(n), y(n);
+   make_bench_inputs(dist, n, 1, &a, &b);
+   for (std::size_t i = 0; i < n; ++i) {
+      a[i] >>= 1;
+      b[i] >>= 1;
+   }
+   auto checksum = [&]() {
+         bench_sink sink;
+         for (std::size_t i = 0; i < n; ++i) {
+            sink.consume(gcd[i]);
+            sink.consume(x[i]);
+            sink.consume(y[i]);
+         }
+         return sink.value();
+      };
+   scalar_extended_euclidean<S, U>(a.data(), b.data(), n, gcd.data(),
+                                   x.data(), y.data());
+   const uint64_t expected = checksum();
+
+   for (const batch_kernel<S, U>& engine : benchmark_engines<S, U>()) {
+      auto run_once = [&]() {
+            engine.function(a.data(), b.data(), n, gcd.data(), x.data(), y.data());
+         };
+      std::vector<double> samples;
+      for (int r = 0; r < runs; ++r)
+         samples.push_back(time_ns_per_call(run_once, n, 1));
+      perf_counter_values c = count_per_call(counters, run_once, n);
+      pJson->add({ engine.name, typeName, bench_distribution_name(dist),
+                   std::numeric_limits<U>::digits, n, samples, c });
+      std::sort(samples.begin(), samples.end());
+      double ns = samples[samples.size() / 2];
+      std::cout << std::left << std::setw(10) << typeName << std::setw(15)
+                << bench_distribution_name(dist) << std::setw(14) << engine.name
+                << std::right << std::fixed << std::setprecision(2)
+                << std::setw(9) << ns;
+      print_count(c.valid[COUNTER_CYCLES] ? c.value[COUNTER_CYCLES] : -1, 9, 1);
+      print_count(c.valid[COUNTER_INSTRUCTIONS] ? c.value[COUNTER_INSTRUCTIONS] : -1, 9, 1);
+      print_count(c.ratio(COUNTER_INSTRUCTIONS, COUNTER_CYCLES), 7, 2);
+      print_count(c.valid[COUNTER_BRANCH_MISSES] ? c.value[COUNTER_BRANCH_MISSES] : -1, 9, 2);
+      double missRate = c.ratio(COUNTER_BRANCH_MISSES, COUNTER_BRANCHES);
+      print_count(missRate < 0 ? -1 : 100 * missRate, 8, 2);
+      double dividerShare = c.ratio(COUNTER_DIVIDER_ACTIVE, COUNTER_CYCLES);
+      print_count(dividerShare < 0 ? -1 : 100 * dividerShare, 7, 1);
+      std::cout << std::defaultfloat << "\n";
+      if (checksum() != expected)
+         std::cout << "error: " << engine.name
+                   << " results differ from unsigned_extended_euclidean\n";
+   }
+}
+
+
+int main(int argc, char *argv[])
+{
+   std::size_t n = 1 << 14;
+   int width = 0;
+   int runs = 5;
+   const char* jsonPath = nullptr;
+   bench_distribution onlyDist = NUM_BENCH_DISTRIBUTIONS;
+   for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--n") == 0 && i + 1 < argc) {
+         n = std::strtoull(argv[++i], nullptr, 10);
+      } else if (std::strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+         width = std::atoi(argv[++i]);
+      } else if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+         runs = std::max(1, std::atoi(argv[++i]));
+      } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+         jsonPath = argv[++i];
+      } else if (std::strcmp(argv[i], "--dist") == 0 && i + 1 < argc) {
+         onlyDist = bench_distribution_from_name(argv[++i]);
+         if (onlyDist == NUM_BENCH_DISTRIBUTIONS) {
+            std::cout << "unknown distribution: " << argv[i] << "\n";
+            return 1;
+         }
+      } else {
+         std::cout << "unknown or incomplete option: " << argv[i] << "\n";
+         return 1;
+      }
+   }
+
+   std::cout << "***Benchmark Extended Euclidean Engines***\n\n";
+   init_extended_euclidean_dispatch();
+   autotune_extended_euclidean();
+   perf_counters counters;
+   bench_json_file json;
+   if (!counters.any_available())
+      std::cout << "(hardware counters are unavailable on this host; "
+                   "reporting times only)\n";
+   else if (!counters.available(COUNTER_DIVIDER_ACTIVE))
+      std::cout << "(no divider-active event for this cpu)\n";
+   print_header();
+   for (bench_distribution dist : { DIST_UNIFORM, DIST_RANDOM_LENGTH, DIST_ADVERSARIAL }) {
+      if (onlyDist != NUM_BENCH_DISTRIBUTIONS && dist != onlyDist)
+         continue;
+      if (width == 0 || width == 16)
+         bench_width<uint16_t>("uint16_t", dist, n, runs, counters, &json);
+      if (width == 0 || width == 32)
+         bench_width<uint32_t>("uint32_t", dist, n, runs, counters, &json);
+      if (width == 0 || width == 64)
+         bench_width<uint64_t>("uint64_t", dist, n, runs, counters, &json);
+   }
+   if (jsonPath != nullptr) {
+      if (!json.write(jsonPath)) {
+         std::cout << "cannot write " << jsonPath << "\n";
+         return 1;
+      }
+      std::cout << "\nwrote " << jsonPath << "\n";
+   }
+   return 0;
+}
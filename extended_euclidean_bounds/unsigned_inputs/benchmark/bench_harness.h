@@ -0,0 +1,115 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Shared helpers for the benchmarks: input distributions built from the
+// generators of input_generators.h, a sink that keeps results observable so
+// the compiler can't discard the work, and a timer that reports the best
+// ns per call over several repetitions.
+
+#ifndef BENCH_HARNESS
+#define BENCH_HARNESS 1
+
+#include "../input_generators.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+
+// The input distributions used by the benchmarks.
+enum bench_distribution {
+   DIST_UNIFORM,          // uniform over [0, max]
+   DIST_RANDOM_LENGTH,    // uniformly chosen bit length, then uniform bits
+   DIST_ADVERSARIAL,      // adversarial_pairs, repeated as needed
+   NUM_BENCH_DISTRIBUTIONS
+};
+
+inline const char* bench_distribution_name(bench_distribution dist)
+{
+   switch (dist) {
+      case DIST_UNIFORM:        return "uniform";
+      case DIST_RANDOM_LENGTH:  return "random_length";
+      case DIST_ADVERSARIAL:    return "adversarial";
+      default:                  return "unknown";
+   }
+}
+
+// returns NUM_BENCH_DISTRIBUTIONS if the name is unknown
+inline bench_distribution bench_distribution_from_name(const char* name)
+{
+   for (int i = 0; i < NUM_BENCH_DISTRIBUTIONS; ++i) {
+      bench_distribution dist = static_cast<bench_distribution>(i);
+      if (std::strcmp(name, bench_distribution_name(dist)) == 0)
+         return dist;
+   }
+   return NUM_BENCH_DISTRIBUTIONS;
+}
+
+
+// Fills a and b with n input pairs of the given distribution.
+template <class U>
+void make_bench_inputs(bench_distribution dist, std::size_t n, uint64_t seed,
+                       std::vector<U>* pA, std::vector<U>* pB)
+{
+   pA->resize(n);
+   pB->resize(n);
+   if (dist == DIST_ADVERSARIAL) {
+      adversarial_pairs<U> pairs;
+      for (std::size_t i = 0; i < n; ++i) {
+         if (!pairs.next(&(*pA)[i], &(*pB)[i])) {
+            pairs.reset();
+            pairs.next(&(*pA)[i], &(*pB)[i]);
+         }
+      }
+   } else {
+      random_pairs<U> pairs(n, seed, dist == DIST_RANDOM_LENGTH);
+      for (std::size_t i = 0; i < n; ++i)
+         pairs.next(&(*pA)[i], &(*pB)[i]);
+   }
+}
+
+
+// Accumulates results so that the work producing them can't be optimized
+// away.  Print or otherwise use value() after timing.
+class bench_sink {
+   uint64_t acc = 0;
+public:
+   template <class V>
+   void consume(V v) { acc = acc * 31 + static_cast<uint64_t>(v); }
+   uint64_t value() const { return acc; }
+};
+
+
+// Calls run_once() repeatedly, where each call performs callsPerRun calls of
+// the function under test, and returns the best observed ns per call over
+// 'repetitions' timed intervals of at least minSeconds each.  If pSamples
+// isn't null, the ns per call of every interval is appended to it.
+template <class RunOnce>
+double time_ns_per_call(RunOnce run_once, std::size_t callsPerRun,
+                        int repetitions = 5, double minSeconds = 0.05,
+                        std::vector<double>* pSamples = nullptr)
+{
+   using clock = std::chrono::steady_clock;
+   run_once();   // warm up caches and branch predictors
+   double best = std::numeric_limits<double>::max();
+   for (int r = 0; r < repetitions; ++r) {
+      uint64_t runs = 0;
+      auto start = clock::now();
+      double elapsed;
+      do {
+         run_once();
+         ++runs;
+         elapsed = std::chrono::duration<double>(clock::now() - start).count();
+      } while (elapsed < minSeconds);
+      double ns = elapsed * 1e9 / (static_cast<double>(runs) * callsPerRun);
+      if (pSamples != nullptr)
+         pSamples->push_back(ns);
+      if (ns < best)
+         best = ns;
+   }
+   return best;
+}
+
+#endif
@@ -0,0 +1,189 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Measures the single-core throughput of interleaved_extended_euclidean() as
+// the interleave width (number of lanes) varies, and of the SIMD kernels the
+// host supports, against a plain loop over unsigned_extended_euclidean(), for
+// each input width and distribution.  The kernel that the dispatcher selects
+// on this host is marked.
+//
+// With --json FILE, also writes the ns per call of every timed repetition
+// and the hardware counts per call of perf_counters.h, for
+// tools/bench_compare (see benchmark/bench_json.h).
+//
+// Usage: bench_interleaved [--n PAIRS] [--json FILE]
+
+#include "bench_harness.h"
+#include "bench_json.h"
+#include "perf_counters.h"
+#include "../unsigned_extended_euclidean.h"
+#include "../interleaved_extended_euclidean.h"
+#include "../extended_euclidean_dispatch.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+
+template <class U>
+struct bench_batch {
+   using S = typename std::make_signed<U>::type;
+   std::vector<U> a, b, gcd;
+   std::vector<S> x, y;
+   perf_counters* pCounters;
+   bench_json_file* pJson;
+
+   bench_batch(bench_distribution dist, std::size_t n, perf_counters* counters,
+               bench_json_file* json)
+      : pCounters(counters), pJson(json)
+   {
+      make_bench_inputs(dist, n, 1, &a, &b);
+      gcd.resize(n);
+      x.resize(n);
+      y.resize(n);
+   }
+   uint64_t checksum() const
+   {
+      bench_sink sink;
+      for (std::size_t i = 0; i < a.size(); ++i) {
+         sink.consume(gcd[i]);
+         sink.consume(x[i]);
+         sink.consume(y[i]);
+      }
+      return sink.value();
+   }
+   // Times run_once(), which solves the whole batch, counts its events, and
+   // adds both to the JSON results as 'engine'; returns the best ns per call.
+   template <class RunOnce>
+   double measure(const char* engine, const char* typeName,
+                  bench_distribution dist, RunOnce run_once)
+   {
+      std::vector<double> samples;
+      double ns = time_ns_per_call(run_once, a.size(), 5, 0.05, &samples);
+      perf_counter_values c = count_per_call(*pCounters, run_once, a.size());
+      pJson->add({ engine, typeName, bench_distribution_name(dist),
+                   std::numeric_limits<U>::digits, a.size(), samples, c });
+      return ns;
+   }
+};
+
+
+void print_row(const char* typeName, bench_distribution dist,
+               const char* variant, double ns, double baselineNs)
+{
+   std::cout << std::left << std::setw(10) << typeName
+             << std::setw(15) << bench_distribution_name(dist)
+             << std::setw(14) << variant << std::right << std::fixed
+             << std::setprecision(2) << std::setw(10) << ns << " ns/call"
+             << std::setw(10) << 1000.0 / ns << " Mcalls/s"
+             << std::setw(9) << baselineNs / ns << "x\n" << std::defaultfloat;
+}
+
+
+template <int LANES, class U>
+void bench_lanes(const char* typeName, bench_distribution dist,
+                 bench_batch<U>* pBatch, double scalarNs, uint64_t expected)
+{
+   using S = typename std::make_signed<U>::type;
+   std::size_t n = pBatch->a.size();
+   char variant[32];
+   std::snprintf(variant, sizeof(variant), "interleave %d", LANES);
+   double ns = pBatch->measure(variant, typeName, dist, [&]() {
+         interleaved_extended_euclidean<LANES, S, U>(pBatch->a.data(),
+                  pBatch->b.data(), n, pBatch->gcd.data(), pBatch->x.data(),
+                  pBatch->y.data());
+      });
+   if (pBatch->checksum() != expected)
+      std::cout << "error: interleaved results differ from the scalar loop\n";
+   print_row(typeName, dist, variant, ns, scalarNs);
+}
+
+
+// every SIMD kernel the host supports
+template <class U>
+void bench_kernels(const char* typeName, bench_distribution dist,
+                   bench_batch<U>* pBatch, double scalarNs, uint64_t expected)
+{
+   using S = typename std::make_signed<U>::type;
+   std::size_t n = pBatch->a.size();
+   const char* selected = dispatched_kernel<S, U>().name;
+   for (const batch_kernel<S, U>& kernel :
+                              supported_kernels<S, U>(host_cpu_features())) {
+      if (std::strncmp(kernel.name, "avx", 3) != 0)
+         continue;
+      double ns = pBatch->measure(kernel.name, typeName, dist, [&]() {
+            kernel.function(pBatch->a.data(), pBatch->b.data(), n,
+                     pBatch->gcd.data(), pBatch->x.data(), pBatch->y.data());
+         });
+      if (pBatch->checksum() != expected)
+         std::cout << "error: " << kernel.name
+                   << " results differ from the scalar loop\n";
+      char variant[32];
+      std::snprintf(variant, sizeof(variant), "%s%s", kernel.name,
+                    std::strcmp(kernel.name, selected) == 0 ? " *" : "");
+      print_row(typeName, dist, variant, ns, scalarNs);
+   }
+}
+
+
+template <class U>
+void bench_width(const char* typeName, std::size_t n, perf_counters* pCounters,
+                 bench_json_file* pJson)
+{
+   using S = typename std::make_signed<U>::type;
+   for (bench_distribution dist : { DIST_UNIFORM, DIST_RANDOM_LENGTH }) {
+      bench_batch<U> batch(dist, n, pCounters, pJson);
+      double scalarNs = batch.measure("scalar", typeName, dist, [&]() {
+            for (std::size_t i = 0; i < n; ++i)
+               unsigned_extended_euclidean<S, U>(batch.a[i], batch.b[i],
+                                      &batch.gcd[i], &batch.x[i], &batch.y[i]);
+         });
+      uint64_t expected = batch.checksum();
+      print_row(typeName, dist, "scalar", scalarNs, scalarNs);
+      bench_lanes<1>(typeName, dist, &batch, scalarNs, expected);
+      bench_lanes<2>(typeName, dist, &batch, scalarNs, expected);
+      bench_lanes<3>(typeName, dist, &batch, scalarNs, expected);
+      bench_lanes<4>(typeName, dist, &batch, scalarNs, expected);
+      bench_lanes<6>(typeName, dist, &batch, scalarNs, expected);
+      bench_lanes<8>(typeName, dist, &batch, scalarNs, expected);
+      bench_kernels<U>(typeName, dist, &batch, scalarNs, expected);
+   }
+}
+
+
+int main(int argc, char *argv[])
+{
+   std::size_t n = 1 << 14;
+   const char* jsonPath = nullptr;
+   for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--n") == 0 && i + 1 < argc) {
+         n = std::strtoull(argv[++i], nullptr, 10);
+      } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+         jsonPath = argv[++i];
+      } else {
+         std::cout << "unknown or incomplete option: " << argv[i] << "\n";
+         return 1;
+      }
+   }
+
+   std::cout << "***Benchmark Interleaved Extended Euclidean (one core)***\n\n";
+   init_extended_euclidean_dispatch();
+   perf_counters counters;
+   bench_json_file json;
+   bench_width<uint32_t>("uint32_t", n, &counters, &json);
+   bench_width<uint64_t>("uint64_t", n, &counters, &json);
+
+   if (jsonPath != nullptr) {
+      if (!json.write(jsonPath)) {
+         std::cout << "cannot write " << jsonPath << "\n";
+         return 1;
+      }
+      std::cout << "\nwrote " << jsonPath << "\n";
+   }
+   return 0;
+}
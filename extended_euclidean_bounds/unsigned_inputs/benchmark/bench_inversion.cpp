@@ -0,0 +1,171 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Compares the engines for odd moduli (the extended gcd and the modular
+// inverse of the constant-time safegcd engine of safegcd_extended_euclidean.h
+// and of the optimized binary GCD of optimized_binary_gcd.h) with the
+// variable-time plain loop, at 64, 128 and 256 bits: the median ns
+// per call over --runs timed runs, on pairs with b odd.  The plain loop is
+// unsigned_extended_euclidean() at 64 and 128 bits, and
+// fixed_width_extended_euclidean() on fixed_uint<4> at 256 bits.
+//
+// The uniform pairs have full length; the random_length pairs have a
+// uniformly chosen bit length, so they take the plain loop fewer iterations
+// on average, while the constant-time engines run the same number of steps.
+//
+// With --json FILE, also writes every run's ns per call and the hardware
+// counts per call of perf_counters.h, for tools/bench_compare (see
+// benchmark/bench_json.h).
+//
+// Usage: bench_inversion [--n PAIRS] [--width 64|128|256] [--runs R]
+//                        [--json FILE]
+
+#include "bench_harness.h"
+#include "bench_json.h"
+#include "perf_counters.h"
+#include "../fast_prng.h"
+#include "../fixed_width_integer.h"
+#include "../optimized_binary_gcd.h"
+#include "../safegcd_extended_euclidean.h"
+#include "../unsigned_extended_euclidean.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+
+// a value of the given bit length, or of full length for length < 0
+template <class U>
+U random_value(xoshiro256ss* rng, int length)
+{
+   constexpr int digits = std::numeric_limits<U>::digits;
+   if (length < 0)
+      length = digits;
+   U v = 0;
+   for (int bits = 0; bits < length; bits += 64) {
+      if constexpr (digits > 64)
+         v = v << 64;
+      v = static_cast<U>(v ^ static_cast<U>(rng->next()));
+   }
+   if (length < digits)
+      v = static_cast<U>(v & static_cast<U>((static_cast<U>(1) << length) - 1u));
+   return v;
+}
+
+template <class U, class Call>
+void bench_engine(const char* engine, const char* typeName, const char* distName,
+                  const std::vector<U>& a, const std::vector<U>& b, int runs,
+                  perf_counters& counters, bench_json_file* pJson, Call call)
+{
+   std::size_t n = a.size();
+   bench_sink sink;
+   auto run_once = [&]() {
+         for (std::size_t i = 0; i < n; ++i)
+            sink.consume(call(a[i], b[i]));
+      };
+   std::vector<double> samples;
+   for (int r = 0; r < runs; ++r)
+      samples.push_back(time_ns_per_call(run_once, n, 1));
+   perf_counter_values c = count_per_call(counters, run_once, n);
+   pJson->add({ engine, typeName, distName, std::numeric_limits<U>::digits, n,
+                samples, c });
+   std::sort(samples.begin(), samples.end());
+   std::cout << std::left << std::setw(10) << typeName << std::setw(15)
+             << distName << std::setw(17) << engine << std::right << std::fixed
+             << std::setprecision(1) << std::setw(10) << samples[samples.size() / 2]
+             << std::defaultfloat << "   (checksum " << sink.value() << ")\n";
+}
+
+template <class S, class U, class Plain>
+void bench_width(const char* typeName, std::size_t n, int runs,
+                 perf_counters& counters, bench_json_file* pJson, Plain plain)
+{
+   constexpr int digits = std::numeric_limits<U>::digits;
+   xoshiro256ss rng(1);
+   for (const char* distName : { "uniform", "random_length" }) {
+      bool uniform = (std::strcmp(distName, "uniform") == 0);
+      std::vector<U> a(n), b(n);
+      for (std::size_t i = 0; i < n; ++i) {
+         a[i] = random_value<U>(&rng, uniform ? -1 : static_cast<int>(rng.next() % (digits + 1)));
+         b[i] = static_cast<U>(random_value<U>(&rng, uniform ? -1
+                                  : static_cast<int>(rng.next() % (digits + 1))) | 1u);
+      }
+      bench_engine("plain", typeName, distName, a, b, runs, counters, pJson, [&](U x, U y) {
+            U gcd;
+            S s, t;
+            plain(x, y, &gcd, &s, &t);
+            return gcd ^ static_cast<U>(s) ^ static_cast<U>(t);
+         });
+      bench_engine("safegcd", typeName, distName, a, b, runs, counters, pJson, [](U x, U y) {
+            U gcd;
+            S s, t;
+            safegcd_extended_euclidean(x, y, &gcd, &s, &t);
+            return gcd ^ static_cast<U>(s) ^ static_cast<U>(t);
+         });
+      bench_engine("safegcd_inverse", typeName, distName, a, b, runs, counters, pJson, [](U x, U y) {
+            return safegcd_inverse(x, y);
+         });
+      bench_engine("binary_gcd", typeName, distName, a, b, runs, counters, pJson, [](U x, U y) {
+            U gcd;
+            S s, t;
+            optimized_binary_extended_euclidean(x, y, &gcd, &s, &t);
+            return gcd ^ static_cast<U>(s) ^ static_cast<U>(t);
+         });
+      bench_engine("binary_inverse", typeName, distName, a, b, runs, counters, pJson, [](U x, U y) {
+            return optimized_binary_inverse(x, y);
+         });
+   }
+}
+
+
+int main(int argc, char *argv[])
+{
+   std::size_t n = 1 << 12;
+   int width = 0;
+   int runs = 5;
+   const char* jsonPath = nullptr;
+   for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--n") == 0 && i + 1 < argc) {
+         n = std::strtoull(argv[++i], nullptr, 10);
+      } else if (std::strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+         width = std::atoi(argv[++i]);
+      } else if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+         runs = std::max(1, std::atoi(argv[++i]));
+      } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+         jsonPath = argv[++i];
+      } else {
+         std::cout << "unknown or incomplete option: " << argv[i] << "\n";
+         return 1;
+      }
+   }
+
+   std::cout << "***Benchmark Inversion Engines For Odd Moduli***\n\n";
+   std::cout << std::left << std::setw(10) << "type" << std::setw(15) << "dist"
+             << std::setw(17) << "engine" << std::right << std::setw(10)
+             << "ns" << "\n";
+   perf_counters counters;
+   bench_json_file json;
+   auto plain = [](auto a, auto b, auto* pGcd, auto* pX, auto* pY) {
+         unsigned_extended_euclidean(a, b, pGcd, pX, pY);
+      };
+   if (width == 0 || width == 64)
+      bench_width<int64_t, uint64_t>("uint64_t", n, runs, counters, &json, plain);
+   if (width == 0 || width == 128)
+      bench_width<__int128, unsigned __int128>("uint128", n, runs, counters, &json, plain);
+   if (width == 0 || width == 256)
+      bench_width<fixed_int<4>, fixed_uint<4>>("uint256", n, runs, counters, &json,
+                                               fixed_width_extended_euclidean<4>);
+
+   if (jsonPath != nullptr) {
+      if (!json.write(jsonPath)) {
+         std::cout << "cannot write " << jsonPath << "\n";
+         return 1;
+      }
+      std::cout << "\nwrote " << jsonPath << "\n";
+   }
+   return 0;
+}
@@ -0,0 +1,176 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Machine-readable benchmark results, for recording baselines and comparing
+// them with tools/bench_compare.  A result file is one JSON object:
+//
+//   { "schema": 1,
+//     "host": { "hostname", "os", "cpu", "vendor", "family", "model",
+//               "avx2", "avx512f", "fast_div64", "compiler", "timestamp" },
+//     "results": [ { "engine", "type", "width", "distribution", "n",
+//                    "ns_per_call": [ one sample per run ... ],
+//                    "counters": { "cycles": per call, ... } }, ... ] }
+//
+// Counters the host doesn't provide are omitted from "counters".  The
+// results of bench_parallel_scaling have none: perf_counters.h counts only
+// the calling thread, not the pool's workers.
+
+#ifndef BENCH_JSON
+#define BENCH_JSON 1
+
+#include "perf_counters.h"
+#include "../cpu_features.h"
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <sys/utsname.h>
+#  include <unistd.h>
+#endif
+
+
+// appends s to out as a JSON string literal
+inline void json_append_string(std::string* out, const char* s)
+{
+   *out += '"';
+   for (; *s != '\0'; ++s) {
+      unsigned char c = static_cast<unsigned char>(*s);
+      if (c == '"' || c == '\\') {
+         *out += '\\';
+         *out += static_cast<char>(c);
+      } else if (c < 0x20) {
+         char escape[8];
+         std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+         *out += escape;
+      } else {
+         *out += static_cast<char>(c);
+      }
+   }
+   *out += '"';
+}
+
+inline void json_append_number(std::string* out, double value)
+{
+   char text[32];
+   std::snprintf(text, sizeof(text), "%.17g", value);
+   *out += text;
+}
+
+
+struct bench_json_result {
+   std::string engine, type, distribution;
+   int width;
+   std::size_t n;
+   std::vector<double> nsPerCall;
+   perf_counter_values counters;
+};
+
+
+// Collects results, and writes them with the host fingerprint.
+class bench_json_file {
+   std::vector<bench_json_result> results;
+
+   static void append_host(std::string* out)
+   {
+      const cpu_features& cpu = host_cpu_features();
+      std::string hostname = "unknown", os = "unknown";
+#if defined(__unix__) || defined(__APPLE__)
+      char name[256];
+      if (gethostname(name, sizeof(name)) == 0) {
+         name[sizeof(name) - 1] = '\0';
+         hostname = name;
+      }
+      utsname u;
+      if (uname(&u) == 0)
+         os = std::string(u.sysname) + " " + u.release + " " + u.machine;
+#endif
+#if defined(__clang__)
+      std::string compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+      std::string compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+      std::string compiler = "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+      std::string compiler = "unknown";
+#endif
+      char timestamp[32];
+      std::time_t now = std::time(nullptr);
+      std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ",
+                    std::gmtime(&now));
+
+      *out += "  \"host\": {\"hostname\": ";
+      json_append_string(out, hostname.c_str());
+      *out += ", \"os\": ";
+      json_append_string(out, os.c_str());
+      *out += ", \"cpu\": ";
+      json_append_string(out, cpu.brand);
+      *out += ", \"vendor\": ";
+      json_append_string(out, cpu.vendor);
+      *out += ", \"family\": ";
+      json_append_number(out, cpu.family);
+      *out += ", \"model\": ";
+      json_append_number(out, cpu.model);
+      *out += std::string(", \"avx2\": ") + (cpu.avx2 ? "true" : "false");
+      *out += std::string(", \"avx512f\": ") + (cpu.avx512f ? "true" : "false");
+      *out += std::string(", \"fast_div64\": ") + (cpu.fastDiv64 ? "true" : "false");
+      *out += ", \"compiler\": ";
+      json_append_string(out, compiler.c_str());
+      *out += ", \"timestamp\": ";
+      json_append_string(out, timestamp);
+      *out += "},\n";
+   }
+
+public:
+   void add(const bench_json_result& result) { results.push_back(result); }
+
+   // returns false if the file can't be written
+   bool write(const char* path) const
+   {
+      std::string out = "{\n  \"schema\": 1,\n";
+      append_host(&out);
+      out += "  \"results\": [\n";
+      for (std::size_t i = 0; i < results.size(); ++i) {
+         const bench_json_result& r = results[i];
+         out += "    {\"engine\": ";
+         json_append_string(&out, r.engine.c_str());
+         out += ", \"type\": ";
+         json_append_string(&out, r.type.c_str());
+         out += ", \"width\": ";
+         json_append_number(&out, r.width);
+         out += ", \"distribution\": ";
+         json_append_string(&out, r.distribution.c_str());
+         out += ", \"n\": ";
+         json_append_number(&out, static_cast<double>(r.n));
+         out += ",\n     \"ns_per_call\": [";
+         for (std::size_t k = 0; k < r.nsPerCall.size(); ++k) {
+            if (k > 0)
+               out += ", ";
+            json_append_number(&out, r.nsPerCall[k]);
+         }
+         out += "],\n     \"counters\": {";
+         bool first = true;
+         for (int id = 0; id < NUM_PERF_COUNTERS; ++id) {
+            if (!r.counters.valid[id])
+               continue;
+            if (!first)
+               out += ", ";
+            first = false;
+            json_append_string(&out, perf_counter_name(static_cast<perf_counter_id>(id)));
+            out += ": ";
+            json_append_number(&out, r.counters.value[id]);
+         }
+         out += (i + 1 < results.size()) ? "}},\n" : "}}\n";
+      }
+      out += "  ]\n}\n";
+
+      std::FILE* file = std::fopen(path, "w");
+      if (file == nullptr)
+         return false;
+      bool ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+      return std::fclose(file) == 0 && ok;
+   }
+};
+
+#endif
@@ -0,0 +1,217 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Measures the latency of individual calls of the scalar engines with the
+// fenced TSC timer of cycle_timer.h, and reports the p50/p90/p99/max latency
+// per bucket of max(bitlen(a), bitlen(b)), for each engine and width from 8
+// to 64 bits.  The unsigned engines are those of scalar_engines() in
+// extended_euclidean_autotune.h, called through their function pointers (so
+// every row pays the same indirect call), and "plain" is
+// unsigned_extended_euclidean().  The iteration count, and so the latency,
+// grows with the bit length: up to about 1.44 iterations per bit for
+// Fibonacci inputs (see --dist adversarial), so compare tails within a bucket.
+//
+// signed_extended_euclidean() requires a, b >= 0, so it is measured on the
+// same inputs shifted right by one bit.
+//
+// With --json FILE, also writes up to LATENCY_JSON_SAMPLES call latencies per
+// bucket (the first ones, in input order), as the result "ENGINE BITS", with
+// the hardware counts per call of perf_counters.h over the bucket's calls,
+// for tools/bench_compare (see benchmark/bench_json.h).
+//
+// Usage: bench_latency [--n PAIRS] [--dist uniform|random_length|adversarial]
+//                      [--group BITS] [--json FILE]
+// --group merges that many consecutive bit lengths into one bucket.
+
+#include "bench_harness.h"
+#include "bench_json.h"
+#include "cycle_timer.h"
+#include "perf_counters.h"
+#include "../extended_euclidean_autotune.h"
+#include "../unsigned_extended_euclidean.h"
+#include "../signed_extended_euclidean.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+constexpr std::size_t LATENCY_JSON_SAMPLES = 256;
+
+struct latency_context {
+   uint64_t overhead;      // ticks of an empty timed region
+   double ticksPerNs;
+   int group;
+   bench_distribution dist;
+   perf_counters* pCounters;
+   bench_json_file* pJson;
+};
+
+
+// Times call(a[i], b[i], &gcd, &x, &y) for every i, and prints the latency
+// percentiles per bit length bucket.
+template <class V, class R, class Call>
+void measure_latency(const char* engine, const char* typeName,
+                     const latency_context& context,
+                     const std::vector<V>& a, const std::vector<V>& b,
+                     Call call)
+{
+   using UV = typename std::make_unsigned<V>::type;
+   const int digits = std::numeric_limits<UV>::digits;
+   std::vector<std::vector<uint64_t>> buckets(digits / context.group + 1);
+   std::vector<std::vector<std::size_t>> members(buckets.size());
+   bench_sink sink;
+   R gcd, x, y;
+   for (std::size_t i = 0; i < a.size(); ++i) {   // warm up
+      call(a[i], b[i], &gcd, &x, &y);
+      sink.consume(gcd);
+   }
+   for (std::size_t i = 0; i < a.size(); ++i) {
+      V ai = a[i], bi = b[i];
+      uint64_t t0 = cycle_timer_start();
+      timing_input(ai);
+      timing_input(bi);
+      call(ai, bi, &gcd, &x, &y);
+      timing_output(gcd);
+      timing_output(x);
+      timing_output(y);
+      uint64_t t1 = cycle_timer_stop();
+      uint64_t ticks = (t1 - t0 > context.overhead) ? t1 - t0 - context.overhead : 0;
+      int bits = std::bit_width(static_cast<UV>(std::max(a[i], b[i])));
+      buckets[bits / context.group].push_back(ticks);
+      members[bits / context.group].push_back(i);
+      sink.consume(gcd ^ x ^ y);
+   }
+
+   for (std::size_t k = 0; k < buckets.size(); ++k) {
+      std::vector<uint64_t>& s = buckets[k];
+      if (s.empty())
+         continue;
+      std::vector<double> samples;
+      for (std::size_t i = 0; i < s.size() && i < LATENCY_JSON_SAMPLES; ++i)
+         samples.push_back(s[i] / context.ticksPerNs);
+      perf_counter_values c = count_per_call(*context.pCounters, [&]() {
+            for (std::size_t i : members[k]) {
+               call(a[i], b[i], &gcd, &x, &y);
+               sink.consume(gcd ^ x ^ y);
+            }
+         }, s.size());
+      std::sort(s.begin(), s.end());
+      auto ns = [&](double p) {
+            return s[static_cast<std::size_t>(p * (s.size() - 1) + 0.5)] / context.ticksPerNs;
+         };
+      int first = static_cast<int>(k) * context.group;
+      int last = std::min(digits, first + context.group - 1);
+      char bits[16];
+      if (first == last)
+         std::snprintf(bits, sizeof(bits), "%d", first);
+      else
+         std::snprintf(bits, sizeof(bits), "%d-%d", first, last);
+      context.pJson->add({ std::string(engine) + " " + bits, typeName,
+                           bench_distribution_name(context.dist), digits,
+                           s.size(), samples, c });
+      std::cout << std::left << std::setw(18) << engine << std::setw(10)
+                << typeName << std::setw(8) << bits
+                << std::right << std::setw(9) << s.size() << std::fixed
+                << std::setprecision(1) << std::setw(9) << ns(0.50)
+                << std::setw(9) << ns(0.90) << std::setw(9) << ns(0.99)
+                << std::setw(10) << s.back() / context.ticksPerNs << "\n"
+                << std::defaultfloat;
+   }
+   std::cout << "   (checksum " << sink.value() << ")\n";
+}
+
+
+template <class U>
+void bench_width(const char* typeName, const char* signedTypeName,
+                 const latency_context& context, std::size_t n)
+{
+   using S = typename std::make_signed<U>::type;
+   std::vector<U> a, b;
+   make_bench_inputs(context.dist, n, 1, &a, &b);
+   std::vector<S> sa(n), sb(n);
+   for (std::size_t i = 0; i < n; ++i) {
+      sa[i] = static_cast<S>(a[i] >> 1);
+      sb[i] = static_cast<S>(b[i] >> 1);
+   }
+
+   for (const scalar_engine<S, U>& engine : scalar_engines<S, U>()) {
+      measure_latency<U, U>(engine.name, typeName, context, a, b,
+            [&engine](U a, U b, U* pGcd, U* pX, U* pY) {
+               S x, y;
+               engine.function(a, b, pGcd, &x, &y);
+               *pX = static_cast<U>(x);
+               *pY = static_cast<U>(y);
+            });
+   }
+   measure_latency<S, S>("signed", signedTypeName, context, sa, sb,
+         [](S a, S b, S* pGcd, S* pX, S* pY) {
+            signed_extended_euclidean<S>(a, b, pGcd, pX, pY);
+         });
+}
+
+
+int main(int argc, char *argv[])
+{
+   std::size_t n = 1 << 18;
+   const char* jsonPath = nullptr;
+   perf_counters counters;
+   bench_json_file json;
+   latency_context context;
+   context.group = 1;
+   context.dist = DIST_RANDOM_LENGTH;
+   context.pCounters = &counters;
+   context.pJson = &json;
+   for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--n") == 0 && i + 1 < argc) {
+         n = std::strtoull(argv[++i], nullptr, 10);
+      } else if (std::strcmp(argv[i], "--dist") == 0 && i + 1 < argc) {
+         context.dist = bench_distribution_from_name(argv[++i]);
+         if (context.dist == NUM_BENCH_DISTRIBUTIONS) {
+            std::cout << "unknown distribution: " << argv[i] << "\n";
+            return 1;
+         }
+      } else if (std::strcmp(argv[i], "--group") == 0 && i + 1 < argc) {
+         context.group = std::max(1, std::atoi(argv[++i]));
+      } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+         jsonPath = argv[++i];
+      } else {
+         std::cout << "unknown or incomplete option: " << argv[i] << "\n";
+         return 1;
+      }
+   }
+
+   context.overhead = cycle_timer_overhead();
+   context.ticksPerNs = tsc_ticks_per_ns();
+   std::cout << "***Benchmark Extended Euclidean Call Latency***\n\n"
+             << "distribution " << bench_distribution_name(context.dist) << ", "
+             << n << " calls per engine; timer overhead " << context.overhead
+             << " ticks, " << std::setprecision(4) << context.ticksPerNs
+             << " ticks/ns\n\n"
+             << std::left << std::setw(18) << "engine" << std::setw(10)
+             << "type" << std::setw(8) << "bits"
+             << std::right << std::setw(9) << "calls" << std::setw(9) << "p50 ns"
+             << std::setw(9) << "p90 ns" << std::setw(9) << "p99 ns"
+             << std::setw(10) << "max ns" << "\n";
+   bench_width<uint8_t>("uint8_t", "int8_t", context, n);
+   bench_width<uint16_t>("uint16_t", "int16_t", context, n);
+   bench_width<uint32_t>("uint32_t", "int32_t", context, n);
+   bench_width<uint64_t>("uint64_t", "int64_t", context, n);
+
+   if (jsonPath != nullptr) {
+      if (!json.write(jsonPath)) {
+         std::cout << "cannot write " << jsonPath << "\n";
+         return 1;
+      }
+      std::cout << "\nwrote " << jsonPath << "\n";
+   }
+   return 0;
+}
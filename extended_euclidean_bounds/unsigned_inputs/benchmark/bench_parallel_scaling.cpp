@@ -0,0 +1,101 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Measures how parallel_extended_euclidean() scales from one thread up to
+// all hardware threads (or --max-threads), on one large batch per width.
+//
+// With --json FILE, also writes the ns per pair of every timed repetition,
+// one result per thread count, for tools/bench_compare (see
+// benchmark/bench_json.h).  The results have no hardware counts, since
+// perf_counters.h counts only the calling thread.
+//
+// Usage: bench_parallel_scaling [--n PAIRS] [--max-threads N] [--json FILE]
+
+#include "bench_harness.h"
+#include "bench_json.h"
+#include "../parallel_extended_euclidean.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+template <class U>
+void bench_scaling(const char* typeName, std::size_t n, unsigned int maxThreads,
+                   bench_json_file* pJson)
+{
+   using S = typename std::make_signed<U>::type;
+   std::vector<U> a, b, g(n);
+   std::vector<S> x(n), y(n);
+   make_bench_inputs(DIST_UNIFORM, n, 1, &a, &b);
+
+   double oneThreadNs = 0;
+   for (unsigned int threads = 1; threads <= maxThreads; ++threads) {
+      work_stealing_pool pool(threads);
+      std::vector<double> samples;
+      double ns = time_ns_per_call([&]() {
+            parallel_extended_euclidean<S, U>(a, b, g, x, y, pool);
+         }, n, 3, 0.2, &samples);
+      char engine[32];
+      std::snprintf(engine, sizeof(engine), "parallel %u", threads);
+      pJson->add({ engine, typeName, bench_distribution_name(DIST_UNIFORM),
+                   std::numeric_limits<U>::digits, n, samples,
+                   perf_counter_values() });
+      if (threads == 1)
+         oneThreadNs = ns;
+      double speedup = oneThreadNs / ns;
+      std::cout << std::left << std::setw(10) << typeName << std::right
+                << std::setw(4) << threads << " threads" << std::fixed
+                << std::setprecision(2) << std::setw(10) << ns << " ns/pair"
+                << std::setw(10) << 1000.0 / ns << " Mpairs/s"
+                << std::setw(8) << speedup << "x"
+                << std::setw(8) << std::setprecision(0)
+                << 100.0 * speedup / threads << "% efficiency\n"
+                << std::defaultfloat;
+   }
+   bench_sink sink;
+   for (std::size_t i = 0; i < n; i += 4096)
+      sink.consume(g[i] ^ static_cast<U>(x[i]) ^ static_cast<U>(y[i]));
+   std::cout << "   (checksum " << sink.value() << ")\n";
+}
+
+
+int main(int argc, char *argv[])
+{
+   std::size_t n = 1 << 22;
+   unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+   const char* jsonPath = nullptr;
+   for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--n") == 0 && i + 1 < argc) {
+         n = std::strtoull(argv[++i], nullptr, 10);
+      } else if (std::strcmp(argv[i], "--max-threads") == 0 && i + 1 < argc) {
+         maxThreads = static_cast<unsigned int>(std::atoi(argv[++i]));
+      } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+         jsonPath = argv[++i];
+      } else {
+         std::cout << "unknown or incomplete option: " << argv[i] << "\n";
+         return 1;
+      }
+   }
+
+   std::cout << "***Benchmark Parallel Extended Euclidean Scaling***\n\n";
+   bench_json_file json;
+   bench_scaling<uint32_t>("uint32_t", n, maxThreads, &json);
+   bench_scaling<uint64_t>("uint64_t", n, maxThreads, &json);
+
+   if (jsonPath != nullptr) {
+      if (!json.write(jsonPath)) {
+         std::cout << "cannot write " << jsonPath << "\n";
+         return 1;
+      }
+      std::cout << "\nwrote " << jsonPath << "\n";
+   }
+   return 0;
+}
@@ -0,0 +1,113 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Timing of short code regions in TSC ticks, for per-call latency
+// measurements.
+//
+//    uint64_t t0 = cycle_timer_start();
+//    ... region ...
+//    uint64_t t1 = cycle_timer_stop();
+//
+// cycle_timer_start() is lfence; rdtsc; lfence, so the region can't begin
+// before the timestamp is taken, and cycle_timer_stop() is rdtscp; lfence,
+// where rdtscp waits for the region's instructions to complete and the lfence
+// keeps later instructions from starting before the timestamp.  (This is the
+// fence pattern of Intel's "How to Benchmark Code Execution Times" paper,
+// with lfence in place of cpuid, which is cheaper and less variable.)
+// Subtract cycle_timer_overhead(), the cost of an empty region, from every
+// measurement.  Use timing_input() and timing_output() on the region's
+// inputs and results, so that the compiler neither hoists the region's work
+// above the start nor sinks it below the stop.
+//
+// TSC ticks are at a constant reference frequency, not core clock cycles;
+// tsc_ticks_per_ns() converts.  Outside of x86 with GCC or Clang, the timer
+// falls back to std::chrono::steady_clock, and a tick is a nanosecond.
+
+#ifndef CYCLE_TIMER
+#define CYCLE_TIMER 1
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#  define CYCLE_TIMER_TSC 1
+#  include <x86intrin.h>
+#else
+#  define CYCLE_TIMER_TSC 0
+#endif
+
+
+inline uint64_t cycle_timer_start()
+{
+#if CYCLE_TIMER_TSC
+   _mm_lfence();
+   uint64_t t = __rdtsc();
+   _mm_lfence();
+   return t;
+#else
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(
+         std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline uint64_t cycle_timer_stop()
+{
+#if CYCLE_TIMER_TSC
+   unsigned int aux;
+   uint64_t t = __rdtscp(&aux);
+   _mm_lfence();
+   return t;
+#else
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(
+         std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+
+// compiler barriers: the value is unknown after timing_input(), and must have
+// been computed by timing_output()
+template <class T>
+inline void timing_input(T& value)
+{
+   asm volatile("" : "+r"(value));
+}
+
+template <class T>
+inline void timing_output(const T& value)
+{
+   asm volatile("" : : "r"(value));
+}
+
+
+// The minimum, over many trials, of an empty timed region.
+inline uint64_t cycle_timer_overhead()
+{
+   uint64_t best = UINT64_MAX;
+   for (int i = 0; i < 100000; ++i) {
+      uint64_t t0 = cycle_timer_start();
+      uint64_t t1 = cycle_timer_stop();
+      best = std::min(best, t1 - t0);
+   }
+   return best;
+}
+
+
+// Timer ticks per nanosecond, measured against steady_clock over about 50 ms.
+inline double tsc_ticks_per_ns()
+{
+#if CYCLE_TIMER_TSC
+   using clock = std::chrono::steady_clock;
+   auto start = clock::now();
+   uint64_t t0 = cycle_timer_start();
+   while (clock::now() - start < std::chrono::milliseconds(50))
+      ;
+   uint64_t t1 = cycle_timer_stop();
+   double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+   return static_cast<double>(t1 - t0) / ns;
+#else
+   return 1.0;
+#endif
+}
+
+#endif
@@ -0,0 +1,207 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Hardware performance counters for the benchmarks, through Linux's
+// perf_event_open(): cycles, instructions, branches, branch misses, and
+// cycles with the integer divider active where the CPU has a known event for
+// it (Intel Skylake and later).  The counters count user-mode events of the
+// calling thread.
+//
+// Counters degrade gracefully: one that can't be opened (no PMU, as in many
+// virtual machines, a restrictive /proc/sys/kernel/perf_event_paranoid, or
+// another OS) is simply unavailable, and its values are reported as invalid.
+// Values are scaled for multiplexing when the kernel had to time-share the
+// hardware counters.
+
+#ifndef PERF_COUNTERS
+#define PERF_COUNTERS 1
+
+#include "../cpu_features.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+
+enum perf_counter_id {
+   COUNTER_CYCLES,
+   COUNTER_INSTRUCTIONS,
+   COUNTER_BRANCHES,
+   COUNTER_BRANCH_MISSES,
+   COUNTER_DIVIDER_ACTIVE,
+   NUM_PERF_COUNTERS
+};
+
+inline const char* perf_counter_name(perf_counter_id id)
+{
+   switch (id) {
+      case COUNTER_CYCLES:          return "cycles";
+      case COUNTER_INSTRUCTIONS:    return "instructions";
+      case COUNTER_BRANCHES:        return "branches";
+      case COUNTER_BRANCH_MISSES:   return "branch_misses";
+      case COUNTER_DIVIDER_ACTIVE:  return "divider_active";
+      default:                      return "unknown";
+   }
+}
+
+
+struct perf_counter_values {
+   double value[NUM_PERF_COUNTERS] = {};
+   bool valid[NUM_PERF_COUNTERS] = {};
+
+   // value[numerator] / value[denominator], or -1 if either is invalid
+   double ratio(perf_counter_id numerator, perf_counter_id denominator) const
+   {
+      if (!valid[numerator] || !valid[denominator] || value[denominator] == 0)
+         return -1;
+      return value[numerator] / value[denominator];
+   }
+};
+
+
+// The raw event config for cycles with the divider busy (the event,
+// umask and cmask = 1 fields), or 0 if none is known for the host.
+inline uint64_t divider_active_event(const cpu_features& cpu)
+{
+   if (std::strcmp(cpu.vendor, "GenuineIntel") != 0 || cpu.family != 6)
+      return 0;
+   switch (cpu.model) {
+      case 0x4E: case 0x5E: case 0x55: case 0x8E: case 0x9E: case 0xA5:
+      case 0xA6:                             // Skylake to Comet Lake
+         return 0x14 | (0x01 << 8) | (1ull << 24);
+      case 0x6A: case 0x6C: case 0x7D: case 0x7E: case 0x8C: case 0x8D:
+      case 0xA7:                             // Ice Lake to Rocket Lake
+         return 0x14 | (0x09 << 8) | (1ull << 24);
+      case 0x8F: case 0xCF: case 0xAD: case 0xAE: case 0x97: case 0x9A:
+      case 0xB7: case 0xBA: case 0xBF:       // Sapphire Rapids, Alder Lake,
+         return 0xB0 | (0x09 << 8) | (1ull << 24);  // and their successors
+      default:
+         return 0;
+   }
+}
+
+
+class perf_counters {
+   int fds[NUM_PERF_COUNTERS];
+
+#ifdef __linux__
+   static int open_counter(uint32_t type, uint64_t config)
+   {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = type;
+      attr.config = config;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                         PERF_FORMAT_TOTAL_TIME_RUNNING;
+      return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+   }
+#endif
+
+public:
+   perf_counters()
+   {
+      for (int& fd : fds)
+         fd = -1;
+#ifdef __linux__
+      fds[COUNTER_CYCLES] = open_counter(PERF_TYPE_HARDWARE,
+                                         PERF_COUNT_HW_CPU_CYCLES);
+      fds[COUNTER_INSTRUCTIONS] = open_counter(PERF_TYPE_HARDWARE,
+                                               PERF_COUNT_HW_INSTRUCTIONS);
+      fds[COUNTER_BRANCHES] = open_counter(PERF_TYPE_HARDWARE,
+                                     PERF_COUNT_HW_BRANCH_INSTRUCTIONS);
+      fds[COUNTER_BRANCH_MISSES] = open_counter(PERF_TYPE_HARDWARE,
+                                                PERF_COUNT_HW_BRANCH_MISSES);
+      uint64_t divider = divider_active_event(host_cpu_features());
+      if (divider != 0)
+         fds[COUNTER_DIVIDER_ACTIVE] = open_counter(PERF_TYPE_RAW, divider);
+#endif
+   }
+
+   ~perf_counters()
+   {
+#ifdef __linux__
+      for (int fd : fds) {
+         if (fd >= 0)
+            close(fd);
+      }
+#endif
+   }
+
+   perf_counters(const perf_counters&) = delete;
+   perf_counters& operator=(const perf_counters&) = delete;
+
+   bool available(perf_counter_id id) const { return fds[id] >= 0; }
+
+   bool any_available() const
+   {
+      for (int fd : fds) {
+         if (fd >= 0)
+            return true;
+      }
+      return false;
+   }
+
+   void start()
+   {
+#ifdef __linux__
+      for (int fd : fds) {
+         if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+         }
+      }
+#endif
+   }
+
+   // the counts since start(), scaled for multiplexing
+   perf_counter_values stop()
+   {
+      perf_counter_values values;
+#ifdef __linux__
+      for (int fd : fds) {
+         if (fd >= 0)
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      }
+      for (int id = 0; id < NUM_PERF_COUNTERS; ++id) {
+         uint64_t data[3];   // value, time enabled, time running
+         if (fds[id] < 0 || read(fds[id], data, sizeof(data)) != sizeof(data) ||
+                 data[2] == 0)
+            continue;
+         values.value[id] = static_cast<double>(data[0]) *
+                            static_cast<double>(data[1]) / static_cast<double>(data[2]);
+         values.valid[id] = true;
+      }
+#endif
+      return values;
+   }
+};
+
+
+// Counts the events of 'repetitions' calls of run_once(), where each call
+// performs callsPerRun calls of the function under test, and returns the
+// counts per call.
+template <class RunOnce>
+perf_counter_values count_per_call(perf_counters& counters, RunOnce run_once,
+                                   std::size_t callsPerRun, int repetitions = 3)
+{
+   run_once();   // warm up caches and branch predictors
+   counters.start();
+   for (int r = 0; r < repetitions; ++r)
+      run_once();
+   perf_counter_values values = counters.stop();
+   for (double& v : values.value)
+      v /= static_cast<double>(callsPerRun) * repetitions;
+   return values;
+}
+
+#endif
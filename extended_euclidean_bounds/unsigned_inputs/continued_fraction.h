@@ -0,0 +1,117 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// The continued fraction of a/b and its convergents, from the quotient loop
+// of unsigned_extended_euclidean().  The quotients q of the loop are the
+// partial quotients of a/b, and its coefficients are the convergents with
+// alternating signs: after the k-th quotient, abs(y2)/abs(x2) is the k-th
+// convergent p_k/h_k, and a*x2 + b*y2 is (up to sign) the next remainder, so
+// abs(a*h_k - b*p_k) is that remainder.  The second-to-last convergent is
+// the (abs(x), abs(y)) the loop returns, and the last is a/b in lowest terms.
+//
+//    continued_fraction<U>             A generator: each next() gives the
+//         next quotient and convergent, one loop step at a time, and returns
+//         false once a/b is exhausted.
+//    best_rational_approximation()     The fraction p/h closest to a/b with
+//         h <= maxDenominator, by the convergents and, at the end, one
+//         semiconvergent; it stops at the first convergent whose denominator
+//         would exceed maxDenominator.
+//
+// The convergents are kept as magnitudes in U, updated by p2 = q*p1 + p0 and
+// h2 = q*h1 + h0, which never overflow: final_bounds.h proves
+// abs(q*x1) <= abs(x2) <= b and abs(q*y1) <= abs(y2) <= max(1,a) for every
+// step, including the last (where x2 and y2 are +-b/gcd and -+a/gcd).
+
+#ifndef CONTINUED_FRACTION
+#define CONTINUED_FRACTION 1
+
+#include "wide_multiply.h"
+#include <limits>
+#include <type_traits>
+#include <assert.h>
+
+
+template <class U>
+class continued_fraction {
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   // the last two convergents p0/h0 and p1/h1, starting from 0/1 and 1/0,
+   // and the remainders a0 == abs(a*h0 - b*p0) and a1 == abs(a*h1 - b*p1)
+   U p0, h0, a0;
+   U p1, h1, a1;
+public:
+   continued_fraction(U a, U b) { reset(a, b); }
+   void reset(U a, U b)
+   {
+      p0 = 0; h0 = 1; a0 = a;
+      p1 = 1; h1 = 0; a1 = b;
+   }
+   // The next partial quotient and convergent; false when there are no more
+   // (immediately, for b == 0).
+   bool next(U* pQuotient, U* pNumerator, U* pDenominator)
+   {
+      if (a1 == 0)
+         return false;
+      U q = a0/a1;
+      U a2 = static_cast<U>(a0 - q*a1);
+      U p2 = static_cast<U>(q*p1 + p0);
+      U h2 = static_cast<U>(q*h1 + h0);
+      p0=p1; h0=h1; a0=a1;
+      p1=p2; h1=h2; a1=a2;
+      *pQuotient = q;
+      *pNumerator = p2;
+      *pDenominator = h2;
+      return true;
+   }
+};
+
+
+// The p/h closest to a/b with 1 <= h <= maxDenominator, for b != 0; of two
+// equally close ones, the one with the smaller denominator (or if they share
+// it, the smaller one).  U is an unsigned type of 8 to 128 bits.
+//
+// Once h1 <= maxDenominator < q*h1 + h0, the candidates are p1/h1 and the
+// semiconvergent (p0 + t*p1)/(h0 + t*h1) with the largest t that fits,
+// t == (maxDenominator - h0)/h1 < q.  Their errors are a1/(b*h1) and
+// (a0 - t*a1)/(b*(h0 + t*h1)), since consecutive convergents err in
+// opposite directions, so they're compared by a double width multiply.
+template <class U>
+void best_rational_approximation(const U a, const U b, const U maxDenominator,
+                                 U* pNumerator, U* pDenominator)
+{
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   assert(b != 0 && maxDenominator != 0);
+   U p0 = 0, h0 = 1, a0 = a;
+   U p1 = 1, h1 = 0, a1 = b;
+
+   // invariant: h1 <= maxDenominator, and h0 <= h1 after the first step
+   while (a1 != 0) {
+      U q = a0/a1;
+      if (h1 != 0 && q > (maxDenominator - h0)/h1) {
+         U t = static_cast<U>((maxDenominator - h0)/h1);
+         if (t != 0) {
+            U ps = static_cast<U>(p0 + t*p1), hs = static_cast<U>(h0 + t*h1);
+            U error = static_cast<U>(a0 - t*a1);
+            U lowS, lowC;
+            U highS = wide_multiply(error, h1, &lowS);
+            U highC = wide_multiply(a1, hs, &lowC);
+            if (highS < highC || (highS == highC && lowS < lowC)) {
+               *pNumerator = ps;
+               *pDenominator = hs;
+               return;
+            }
+         }
+         break;
+      }
+      U a2 = static_cast<U>(a0 - q*a1);
+      U p2 = static_cast<U>(q*p1 + p0);
+      U h2 = static_cast<U>(q*h1 + h0);
+      p0=p1; h0=h1; a0=a1;
+      p1=p2; h1=h2; a1=a2;
+   }
+   *pNumerator = p1;
+   *pDenominator = h1;
+}
+
+#endif
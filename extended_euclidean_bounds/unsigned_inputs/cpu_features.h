@@ -0,0 +1,138 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Probes the features of the host CPU that the batched kernels care about:
+// whether the AVX2 and AVX-512 kernels may run (the CPU supports them and the
+// OS saves their registers), and whether 64-bit integer division is fast.
+// On anything other than x86 with GCC or Clang, no features are reported.
+
+#ifndef CPU_FEATURES
+#define CPU_FEATURES 1
+
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#  define CPU_FEATURES_X86 1
+#  include <cpuid.h>
+#else
+#  define CPU_FEATURES_X86 0
+#endif
+
+
+struct cpu_features {
+   char vendor[13] = "";
+   char brand[49] = "";       // the processor brand string, if reported
+   unsigned int family = 0;   // display family and model, as in the
+   unsigned int model = 0;    // Intel and AMD manuals
+   bool avx2 = false;         // AVX2 and FMA
+   bool avx512f = false;
+   bool fastDiv64 = false;    // a 64-bit div with latency of roughly 20
+                              // cycles or less
+};
+
+
+#if CPU_FEATURES_X86
+inline uint64_t cpu_features_xgetbv0()
+{
+   uint32_t lo, hi;
+   __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+   return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+#endif
+
+
+// A heuristic by vendor and model: Intel's divider became fast with Ice Lake
+// and Tremont (earlier cores take 35 to 90 cycles for a 64-bit div), and
+// AMD's with Zen 3 (family 19h).
+inline bool cpu_has_fast_div64(const cpu_features& cpu)
+{
+   if (std::strcmp(cpu.vendor, "AuthenticAMD") == 0)
+      return cpu.family >= 0x19;
+   if (std::strcmp(cpu.vendor, "GenuineIntel") != 0)
+      return false;
+   if (cpu.family != 6)
+      return cpu.family > 6;
+   static const unsigned int fastModels[] = {
+      0x6A, 0x6C,             // Ice Lake server
+      0x7D, 0x7E,             // Ice Lake client
+      0x86, 0x8A, 0x96, 0x9C, // Tremont
+      0x8C, 0x8D,             // Tiger Lake
+      0x8F,                   // Sapphire Rapids
+      0x97, 0x9A, 0xBE,       // Alder Lake
+      0xA7,                   // Rocket Lake
+      0xAA, 0xAC,             // Meteor Lake
+      0xAD, 0xAE,             // Granite Rapids
+      0xAF,                   // Sierra Forest
+      0xB7, 0xBA, 0xBF,       // Raptor Lake
+      0xBD,                   // Lunar Lake
+      0xC5, 0xC6,             // Arrow Lake
+      0xCF                    // Emerald Rapids
+   };
+   for (unsigned int m : fastModels) {
+      if (cpu.model == m)
+         return true;
+   }
+   return false;
+}
+
+
+inline cpu_features detect_cpu_features()
+{
+   cpu_features cpu;
+#if CPU_FEATURES_X86
+   unsigned int eax, ebx, ecx, edx;
+   if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx))
+      return cpu;
+   unsigned int maxLeaf = eax;
+   std::memcpy(cpu.vendor, &ebx, 4);
+   std::memcpy(cpu.vendor + 4, &edx, 4);
+   std::memcpy(cpu.vendor + 8, &ecx, 4);
+   cpu.vendor[12] = '\0';
+   if (maxLeaf < 1)
+      return cpu;
+
+   __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+   cpu.family = (eax >> 8) & 0xF;
+   cpu.model = (eax >> 4) & 0xF;
+   if (cpu.family == 0xF)
+      cpu.family += (eax >> 20) & 0xFF;
+   if (cpu.family == 6 || cpu.family >= 0xF)
+      cpu.model += ((eax >> 16) & 0xF) << 4;
+   bool fma = (ecx >> 12) & 1;
+   bool osxsave = (ecx >> 27) & 1;
+   bool avx = (ecx >> 28) & 1;
+   uint64_t xcr0 = osxsave ? cpu_features_xgetbv0() : 0;
+   bool osSavesYmm = (xcr0 & 0x06) == 0x06;
+   bool osSavesZmm = (xcr0 & 0xE6) == 0xE6;
+
+   if (maxLeaf >= 7) {
+      __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx);
+      bool avx2 = (ebx >> 5) & 1;
+      bool avx512f = (ebx >> 16) & 1;
+      cpu.avx2 = avx && fma && avx2 && osSavesYmm;
+      cpu.avx512f = cpu.avx2 && avx512f && osSavesZmm;
+   }
+   cpu.fastDiv64 = cpu_has_fast_div64(cpu);
+
+   if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000004) {
+      unsigned int regs[12];
+      for (unsigned int i = 0; i < 3; ++i)
+         __get_cpuid(0x80000002 + i, &regs[4*i], &regs[4*i + 1],
+                     &regs[4*i + 2], &regs[4*i + 3]);
+      std::memcpy(cpu.brand, regs, 48);
+      cpu.brand[48] = '\0';
+   }
+#endif
+   return cpu;
+}
+
+
+// the features of the host, probed on first use
+inline const cpu_features& host_cpu_features()
+{
+   static const cpu_features cpu = detect_cpu_features();
+   return cpu;
+}
+
+#endif
@@ -0,0 +1,362 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Selects the fastest scalar engine for each input width by measurement.
+// Which of the engines registered in scalar_engines() below
+// (unsigned_extended_euclidean() and its alternative implementations) is
+// fastest depends on the microarchitecture (mainly the latency of its integer
+// and FP dividers, and its cache sizes) and on the width, so rather than
+// guess, the autotuner times every engine that passes a self-test on a few
+// thousand uniformly random pairs, interleaving the engines over several
+// rounds and keeping each one's best round.  That takes a few milliseconds
+// per width.
+//
+// The winner is remembered per (CPU vendor, family, model, width) in a small
+// text cache file, so later processes on the same machine bind it without
+// timing anything.  The file is $EXTENDED_EUCLIDEAN_AUTOTUNE_CACHE if that
+// is set (to an empty value to disable the cache), and otherwise
+// extended_euclidean_autotune.txt in $XDG_CACHE_HOME or $HOME/.cache, if
+// that directory exists.  A cached engine that is unknown or fails its
+// self-test is retuned.  EXTENDED_EUCLIDEAN_ENGINE=<name> forces an engine,
+// as EXTENDED_EUCLIDEAN_KERNEL does for extended_euclidean_dispatch.h.
+//
+// tuned_extended_euclidean() has the interface and the results of
+// unsigned_extended_euclidean().  Its first call for a width tunes that width
+// (or autotune_extended_euclidean() tunes all the standard widths up front,
+// optionally forcing a fresh measurement); every call after that is a single
+// indirect call of the chosen engine.
+
+#ifndef EXTENDED_EUCLIDEAN_AUTOTUNE
+#define EXTENDED_EUCLIDEAN_AUTOTUNE 1
+
+#include "unsigned_extended_euclidean.h"
+#include "extended_euclidean_variants.h"
+#include "extended_euclidean_endgame.h"
+#include "unrolled_extended_euclidean.h"
+#include "extended_euclidean_dispatch.h"
+#include "cpu_features.h"
+#include "input_generators.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+template <class S, class U>
+using scalar_engine_function = void (*)(U a, U b, U* pGcd, S* pX, S* pY);
+
+template <class S, class U>
+struct scalar_engine {
+   const char* name;
+   scalar_engine_function<S, U> function;
+   batch_kernel_function<S, U> batch;   // a loop over function, inlined
+};
+
+
+template <class S, class U, scalar_engine_function<S, U> F>
+void scalar_engine_loop(const U* a, const U* b, std::size_t n,
+                        U* pGcd, S* pX, S* pY)
+{
+   for (std::size_t i = 0; i < n; ++i)
+      F(a[i], b[i], &pGcd[i], &pX[i], &pY[i]);
+}
+
+#define SCALAR_ENGINE(name, function) \
+   { name, &function<S, U>, &scalar_engine_loop<S, U, &function<S, U>> }
+
+// The candidate engines for this width.  Register new scalar engines here.
+template <class S, class U>
+const std::vector<scalar_engine<S, U>>& scalar_engines()
+{
+   static const std::vector<scalar_engine<S, U>> engines = {
+      SCALAR_ENGINE("plain", unsigned_extended_euclidean),
+      SCALAR_ENGINE("small_quotient", small_quotient_extended_euclidean),
+      SCALAR_ENGINE("fp_reciprocal", fp_reciprocal_extended_euclidean),
+      SCALAR_ENGINE("binary", binary_extended_euclidean),
+      SCALAR_ENGINE("lehmer", lehmer_extended_euclidean),
+      SCALAR_ENGINE("width_descending", width_descending_extended_euclidean),
+      SCALAR_ENGINE("deferred_y", deferred_y_extended_euclidean),
+      { "unrolled2", &unrolled_extended_euclidean<2, S, U>,
+        &scalar_engine_loop<S, U, &unrolled_extended_euclidean<2, S, U>> },
+      { "unrolled4", &unrolled_extended_euclidean<4, S, U>,
+        &scalar_engine_loop<S, U, &unrolled_extended_euclidean<4, S, U>> },
+      SCALAR_ENGINE("endgame", endgame_extended_euclidean),
+   };
+   return engines;
+}
+
+#undef SCALAR_ENGINE
+
+
+// ---- the cache file ----
+
+// the default cache file, or "" for none
+inline std::string autotune_cache_path()
+{
+   const char* path = std::getenv("EXTENDED_EUCLIDEAN_AUTOTUNE_CACHE");
+   if (path != nullptr)
+      return path;
+   std::string dir;
+   if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg != nullptr && *xdg != '\0')
+      dir = xdg;
+   else if (const char* home = std::getenv("HOME"); home != nullptr && *home != '\0')
+      dir = std::string(home) + "/.cache";
+   else
+      return "";
+   // if the directory doesn't exist, writes fail and nothing is cached
+   return dir + "/extended_euclidean_autotune.txt";
+}
+
+// the cache key of a width on a cpu, e.g. "GenuineIntel 6 207 64"
+inline std::string autotune_cache_key(const cpu_features& cpu, int digits)
+{
+   char key[64];
+   std::snprintf(key, sizeof(key), "%s %u %u %d",
+                 (cpu.vendor[0] != '\0') ? cpu.vendor : "unknown",
+                 cpu.family, cpu.model, digits);
+   return key;
+}
+
+// The lines of the cache file are "<key> <engine name>"; lines starting with
+// '#' are comments.  Returns the engine name for the key, or "" if none.
+inline std::string read_autotune_cache(const std::string& path,
+                                       const std::string& key)
+{
+   std::FILE* file = path.empty() ? nullptr : std::fopen(path.c_str(), "r");
+   if (file == nullptr)
+      return "";
+   std::string name;
+   char line[256];
+   while (std::fgets(line, sizeof(line), file) != nullptr) {
+      std::string s = line;
+      while (!s.empty() && (s.back() == '\n' || s.back() == '\r'))
+         s.pop_back();
+      if (s.empty() || s[0] == '#' || s.size() <= key.size() + 1 ||
+              s.compare(0, key.size(), key) != 0 || s[key.size()] != ' ')
+         continue;
+      name = s.substr(key.size() + 1);
+   }
+   std::fclose(file);
+   return name;
+}
+
+// Records the engine for the key, replacing any earlier entry.  The file is
+// rewritten through a temporary and a rename, so a concurrent reader sees
+// either the old or the new file.  Returns false on failure.
+inline bool write_autotune_cache(const std::string& path, const std::string& key,
+                                 const char* name)
+{
+   if (path.empty())
+      return false;
+   std::string contents = "# extended_euclidean autotune cache: "
+                          "<vendor> <family> <model> <bits> <engine>\n";
+   if (std::FILE* file = std::fopen(path.c_str(), "r"); file != nullptr) {
+      char line[256];
+      while (std::fgets(line, sizeof(line), file) != nullptr) {
+         std::string s = line;
+         if (s.empty() || s[0] == '#' || (s.compare(0, key.size(), key) == 0 &&
+                                          s.size() > key.size() && s[key.size()] == ' '))
+            continue;
+         contents += s;
+         if (contents.back() != '\n')
+            contents += '\n';
+      }
+      std::fclose(file);
+   }
+   contents += key + " " + name + "\n";
+
+   std::string temp = path + ".tmp";
+   std::FILE* file = std::fopen(temp.c_str(), "w");
+   if (file == nullptr)
+      return false;
+   bool ok = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+   ok = (std::fclose(file) == 0) && ok;
+   if (ok && std::rename(temp.c_str(), path.c_str()) != 0) {
+      std::remove(path.c_str());   // rename() can't replace a file on Windows
+      ok = std::rename(temp.c_str(), path.c_str()) == 0;
+   }
+   if (!ok)
+      std::remove(temp.c_str());
+   return ok;
+}
+
+
+// ---- tuning ----
+
+// The best time of each engine over a few rounds on the same random pairs;
+// engines that fail their self-test get an infinite time.
+template <class S, class U>
+std::vector<double> time_scalar_engines(const std::vector<scalar_engine<S, U>>& engines)
+{
+   using clock = std::chrono::steady_clock;
+   const std::size_t n = 2048;
+   const int rounds = 5;
+   std::vector<U> a, b, gcd(n);
+   std::vector<S> x(n), y(n);
+   random_pairs<U> random(n, 0x5eed, false);
+   U u, v;
+   while (random.next(&u, &v)) {
+      a.push_back(u);
+      b.push_back(v);
+   }
+   std::vector<double> best(engines.size(), std::numeric_limits<double>::infinity());
+   std::vector<bool> usable(engines.size());
+   for (std::size_t e = 0; e < engines.size(); ++e) {
+      usable[e] = self_test_kernel<S, U>(engines[e].batch);
+      if (!usable[e])
+         std::fprintf(stderr, "extended_euclidean_autotune: engine '%s' failed "
+                      "its self-test for %d-bit inputs, skipped\n",
+                      engines[e].name, std::numeric_limits<U>::digits);
+   }
+   for (int r = 0; r < rounds; ++r) {
+      for (std::size_t e = 0; e < engines.size(); ++e) {
+         if (!usable[e])
+            continue;
+         auto start = clock::now();
+         engines[e].batch(a.data(), b.data(), n, gcd.data(), x.data(), y.data());
+         double seconds = std::chrono::duration<double>(clock::now() - start).count();
+         if (seconds < best[e])
+            best[e] = seconds;
+      }
+   }
+   return best;
+}
+
+
+// Chooses the engine for this width: the one named by 'requested' if it is
+// non-null, known and passes its self-test; else the cached choice for this
+// cpu, unless 'retune' is set; else the fastest by measurement, which is then
+// cached.  'cachePath' may be empty, for no cache.
+template <class S, class U>
+const scalar_engine<S, U>& autotune_engine(const cpu_features& cpu,
+                                           const std::string& cachePath,
+                                           bool retune, const char* requested)
+{
+   const int bits = std::numeric_limits<U>::digits;
+   const std::vector<scalar_engine<S, U>>& engines = scalar_engines<S, U>();
+   auto usable = [&](const std::string& name) -> const scalar_engine<S, U>* {
+         for (const scalar_engine<S, U>& engine : engines) {
+            if (name == engine.name && self_test_kernel<S, U>(engine.batch))
+               return &engine;
+         }
+         return nullptr;
+      };
+   if (requested != nullptr && *requested != '\0') {
+      if (const scalar_engine<S, U>* engine = usable(requested))
+         return *engine;
+      std::fprintf(stderr, "extended_euclidean_autotune: engine '%s' is unknown "
+                   "or failed its self-test for %d-bit inputs\n", requested, bits);
+   }
+   std::string key = autotune_cache_key(cpu, bits);
+   if (!retune) {
+      std::string cached = read_autotune_cache(cachePath, key);
+      if (!cached.empty()) {
+         if (const scalar_engine<S, U>* engine = usable(cached))
+            return *engine;
+      }
+   }
+   std::vector<double> times = time_scalar_engines<S, U>(engines);
+   std::size_t best = 0;   // "plain" is the reference, so it never fails
+   for (std::size_t e = 1; e < engines.size(); ++e) {
+      if (times[e] < times[best])
+         best = e;
+   }
+   write_autotune_cache(cachePath, key, engines[best].name);
+   return engines[best];
+}
+
+
+// ---- routing ----
+
+template <class S, class U>
+void untuned_extended_euclidean(U a, U b, U* pGcd, S* pX, S* pY);
+template <class S, class U>
+void untuned_extended_euclidean_batch(const U* a, const U* b, std::size_t n,
+                                      U* pGcd, S* pX, S* pY);
+
+// the placeholder bound before tuning, which tunes on its first call
+template <class S, class U>
+inline const scalar_engine<S, U> untuned_engine = {
+   "untuned", &untuned_extended_euclidean<S, U>,
+   &untuned_extended_euclidean_batch<S, U>
+};
+
+template <class S, class U>
+inline std::atomic<const scalar_engine<S, U>*> tuned_engine_binding{
+   &untuned_engine<S, U>
+};
+
+// Binds the engine for this width, unless one is bound already and 'retune'
+// is false, and returns the bound engine.
+template <class S, class U>
+const scalar_engine<S, U>& bind_tuned_engine(bool retune, const std::string& cachePath)
+{
+   static std::mutex mutex;
+   std::lock_guard<std::mutex> lock(mutex);
+   const scalar_engine<S, U>* engine =
+                           tuned_engine_binding<S, U>.load(std::memory_order_acquire);
+   if (engine == &untuned_engine<S, U> || retune) {
+      engine = &autotune_engine<S, U>(host_cpu_features(), cachePath, retune,
+                                      std::getenv("EXTENDED_EUCLIDEAN_ENGINE"));
+      tuned_engine_binding<S, U>.store(engine, std::memory_order_release);
+   }
+   return *engine;
+}
+
+template <class S, class U>
+void untuned_extended_euclidean(U a, U b, U* pGcd, S* pX, S* pY)
+{
+   bind_tuned_engine<S, U>(false, autotune_cache_path()).function(a, b, pGcd, pX, pY);
+}
+
+template <class S, class U>
+void untuned_extended_euclidean_batch(const U* a, const U* b, std::size_t n,
+                                      U* pGcd, S* pX, S* pY)
+{
+   bind_tuned_engine<S, U>(false, autotune_cache_path()).batch(a, b, n, pGcd, pX, pY);
+}
+
+
+// The results are identical to those of unsigned_extended_euclidean().
+template <class S, class U>
+inline void tuned_extended_euclidean(const U a, const U b, U* pGcd, S* pX, S* pY)
+{
+   tuned_engine_binding<S, U>.load(std::memory_order_acquire)->function(a, b, pGcd, pX, pY);
+}
+
+// For every i < n, the results pGcd[i], pX[i], pY[i] are identical to those
+// of unsigned_extended_euclidean(a[i], b[i], ...).
+template <class S, class U>
+inline void tuned_extended_euclidean_batch(const U* a, const U* b, std::size_t n,
+                                           U* pGcd, S* pX, S* pY)
+{
+   tuned_engine_binding<S, U>.load(std::memory_order_acquire)->batch(a, b, n, pGcd, pX, pY);
+}
+
+// the name of the engine bound for this width ("untuned" before tuning)
+template <class S, class U>
+const char* tuned_engine_name()
+{
+   return tuned_engine_binding<S, U>.load(std::memory_order_acquire)->name;
+}
+
+
+// Tunes all the standard widths now, rather than on first use; with 'retune'
+// set, measures afresh even if engines are bound or cached.
+inline void autotune_extended_euclidean(bool retune = false,
+                                        const std::string& cachePath = autotune_cache_path())
+{
+   bind_tuned_engine<int8_t, uint8_t>(retune, cachePath);
+   bind_tuned_engine<int16_t, uint16_t>(retune, cachePath);
+   bind_tuned_engine<int32_t, uint32_t>(retune, cachePath);
+   bind_tuned_engine<int64_t, uint64_t>(retune, cachePath);
+}
+
+#endif
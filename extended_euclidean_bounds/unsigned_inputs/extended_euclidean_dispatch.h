@@ -0,0 +1,192 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Runtime selection of the batched extended gcd kernel.  For each input
+// width, the first call of dispatched_extended_euclidean() (or of
+// init_extended_euclidean_dispatch(), for programs that want the cost and any
+// diagnostics at startup) probes the host CPU once, and binds the fastest
+// kernel the host supports that passes a self-test against
+// unsigned_extended_euclidean().  Every later call goes through that binding.
+//
+// The kernels, in order of preference:
+//   avx512        SIMD kernel, 16 lanes   (inputs of at most 32 bits)
+//   avx2          SIMD kernel, 8 lanes    (inputs of at most 32 bits)
+//   interleaved4  interleaved_extended_euclidean<4>
+//   interleaved8  interleaved_extended_euclidean<8>
+//   scalar        a loop over unsigned_extended_euclidean()
+// For 64-bit inputs on a CPU with a slow 64-bit divider, interleaved8 is
+// preferred to interleaved4, to keep more of the long divisions in flight.
+//
+// The environment variable EXTENDED_EUCLIDEAN_KERNEL=<name> forces a kernel
+// for every width that it's available for; a kernel that is unavailable or
+// fails its self-test is reported on stderr and automatic selection is used
+// instead.
+
+#ifndef EXTENDED_EUCLIDEAN_DISPATCH
+#define EXTENDED_EUCLIDEAN_DISPATCH 1
+
+#include "unsigned_extended_euclidean.h"
+#include "interleaved_extended_euclidean.h"
+#include "simd_extended_euclidean.h"
+#include "cpu_features.h"
+#include "input_generators.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+
+template <class S, class U>
+using batch_kernel_function = void (*)(const U* a, const U* b, std::size_t n,
+                                       U* pGcd, S* pX, S* pY);
+
+template <class S, class U>
+struct batch_kernel {
+   const char* name;
+   batch_kernel_function<S, U> function;
+};
+
+
+template <class S, class U>
+void scalar_extended_euclidean(const U* a, const U* b, std::size_t n,
+                               U* pGcd, S* pX, S* pY)
+{
+   for (std::size_t i = 0; i < n; ++i)
+      unsigned_extended_euclidean<S, U>(a[i], b[i], &pGcd[i], &pX[i], &pY[i]);
+}
+
+
+// The kernels for this width that the given CPU supports, fastest first.
+template <class S, class U>
+std::vector<batch_kernel<S, U>> supported_kernels(const cpu_features& cpu)
+{
+   std::vector<batch_kernel<S, U>> kernels;
+#if SIMD_EXTENDED_EUCLIDEAN_X86
+   if constexpr (std::numeric_limits<U>::digits <= 32) {
+      if (cpu.avx512f)
+         kernels.push_back({ "avx512", &simd_extended_euclidean_avx512<S, U> });
+      if (cpu.avx2)
+         kernels.push_back({ "avx2", &simd_extended_euclidean_avx2<S, U> });
+   }
+#endif
+   batch_kernel<S, U> interleaved4 = { "interleaved4",
+                           &interleaved_extended_euclidean<4, S, U> };
+   batch_kernel<S, U> interleaved8 = { "interleaved8",
+                           &interleaved_extended_euclidean<8, S, U> };
+   if (std::numeric_limits<U>::digits > 32 && !cpu.fastDiv64) {
+      kernels.push_back(interleaved8);
+      kernels.push_back(interleaved4);
+   } else {
+      kernels.push_back(interleaved4);
+      kernels.push_back(interleaved8);
+   }
+   kernels.push_back({ "scalar", &scalar_extended_euclidean<S, U> });
+   return kernels;
+}
+
+
+// Cross-checks a kernel against unsigned_extended_euclidean() on the
+// adversarial inputs and a batch of random ones, with a batch size that isn't
+// a multiple of any kernel's lane count.  Returns true if all results agree.
+template <class S, class U>
+bool self_test_kernel(batch_kernel_function<S, U> kernel)
+{
+   std::vector<U> a, b;
+   U u, v;
+   adversarial_pairs<U> adversarial;
+   while (adversarial.next(&u, &v)) {
+      a.push_back(u);
+      b.push_back(v);
+   }
+   random_pairs<U> random(1021, 1, true);
+   while (random.next(&u, &v)) {
+      a.push_back(u);
+      b.push_back(v);
+   }
+   std::size_t n = a.size();
+   std::vector<U> gcd(n);
+   std::vector<S> x(n), y(n);
+   kernel(a.data(), b.data(), n, gcd.data(), x.data(), y.data());
+   for (std::size_t i = 0; i < n; ++i) {
+      U gcd2;
+      S x2, y2;
+      unsigned_extended_euclidean<S, U>(a[i], b[i], &gcd2, &x2, &y2);
+      if (gcd[i] != gcd2 || x[i] != x2 || y[i] != y2)
+         return false;
+   }
+   return true;
+}
+
+
+// Chooses the kernel for this width: the one named by 'requested' if it is
+// non-null, supported and passes its self-test, and otherwise the first
+// supported kernel that passes its self-test.  The scalar kernel is the
+// reference itself, so it always passes.
+template <class S, class U>
+batch_kernel<S, U> select_kernel(const cpu_features& cpu, const char* requested)
+{
+   const int bits = std::numeric_limits<U>::digits;
+   std::vector<batch_kernel<S, U>> kernels = supported_kernels<S, U>(cpu);
+   if (requested != nullptr && *requested != '\0') {
+      bool found = false;
+      for (const batch_kernel<S, U>& kernel : kernels) {
+         if (std::strcmp(kernel.name, requested) != 0)
+            continue;
+         found = true;
+         if (self_test_kernel<S, U>(kernel.function))
+            return kernel;
+         std::fprintf(stderr, "extended_euclidean_dispatch: kernel '%s' failed "
+                      "its self-test for %d-bit inputs\n", requested, bits);
+      }
+      if (!found) {
+         std::fprintf(stderr, "extended_euclidean_dispatch: kernel '%s' is "
+                      "unavailable for %d-bit inputs on this cpu\n",
+                      requested, bits);
+      }
+   }
+   for (const batch_kernel<S, U>& kernel : kernels) {
+      if (self_test_kernel<S, U>(kernel.function))
+         return kernel;
+      std::fprintf(stderr, "extended_euclidean_dispatch: kernel '%s' failed "
+                   "its self-test for %d-bit inputs, skipped\n",
+                   kernel.name, bits);
+   }
+   return kernels.back();
+}
+
+
+// the kernel bound for this width, selected on first use
+template <class S, class U>
+const batch_kernel<S, U>& dispatched_kernel()
+{
+   static const batch_kernel<S, U> kernel = select_kernel<S, U>(
+               host_cpu_features(), std::getenv("EXTENDED_EUCLIDEAN_KERNEL"));
+   return kernel;
+}
+
+
+// For every i < n, the results pGcd[i], pX[i], pY[i] are identical to those
+// of unsigned_extended_euclidean(a[i], b[i], ...).
+template <class S, class U>
+void dispatched_extended_euclidean(const U* a, const U* b, std::size_t n,
+                                   U* pGcd, S* pX, S* pY)
+{
+   dispatched_kernel<S, U>().function(a, b, n, pGcd, pX, pY);
+}
+
+
+// Selects the kernels of all the standard widths now, rather than on first
+// use.
+inline void init_extended_euclidean_dispatch()
+{
+   dispatched_kernel<int8_t, uint8_t>();
+   dispatched_kernel<int16_t, uint16_t>();
+   dispatched_kernel<int32_t, uint32_t>();
+   dispatched_kernel<int64_t, uint64_t>();
+}
+
+#endif
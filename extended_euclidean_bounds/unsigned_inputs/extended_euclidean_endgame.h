@@ -0,0 +1,100 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// A table-driven endgame for the extended Euclidean algorithm.  Once both
+// remainders a0, a1 are below 256, the rest of the quotient sequence depends
+// only on (a0, a1), and so does the product of the remaining steps: if
+// gcd(a0, a1) == s*a0 + t*a1 is the Euclidean result for the pair, then
+// applying the remaining steps to the coefficients gives the final
+// coefficients s*x0 + t*x1 and s*y0 + t*y1.  By the final bounds, |s| and |t|
+// are at most 127 for such pairs, so the table holds one int8_t pair per
+// (a0, a1): 128 KiB, which stays in the L2 cache.  It is built on first use,
+// from unsigned_extended_euclidean<int8_t, uint8_t>().
+//
+// endgame_extended_euclidean() runs the plain loop until both remainders are
+// below 256 and then finishes with one lookup and one matrix application.
+// For uint8_t inputs there is no loop at all: the table entry for (a, b) is
+// the result.  Both have the interface and results of
+// unsigned_extended_euclidean().
+
+#ifndef EXTENDED_EUCLIDEAN_ENDGAME
+#define EXTENDED_EUCLIDEAN_ENDGAME 1
+
+#include "unsigned_extended_euclidean.h"
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+
+struct endgame_entry {
+   int8_t s, t;   // gcd(a0, a1) == s*a0 + t*a1
+};
+
+constexpr unsigned int ENDGAME_LIMIT = 256;
+
+// the table, indexed by a0*ENDGAME_LIMIT + a1, built on first use
+inline const endgame_entry* endgame_table()
+{
+   static const std::vector<endgame_entry> table = [] {
+         std::vector<endgame_entry> t(ENDGAME_LIMIT * ENDGAME_LIMIT);
+         for (unsigned int a0 = 0; a0 < ENDGAME_LIMIT; ++a0) {
+            for (unsigned int a1 = 0; a1 < ENDGAME_LIMIT; ++a1) {
+               uint8_t gcd;
+               endgame_entry& e = t[a0 * ENDGAME_LIMIT + a1];
+               unsigned_extended_euclidean<int8_t, uint8_t>(
+                        static_cast<uint8_t>(a0), static_cast<uint8_t>(a1),
+                        &gcd, &e.s, &e.t);
+            }
+         }
+         return t;
+      }();
+   return table.data();
+}
+
+
+template <class S, class U>
+void endgame_extended_euclidean(const U a, const U b, U* pGcd, S* pX, S* pY)
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+   const endgame_entry* table = endgame_table();
+   if constexpr (std::numeric_limits<U>::digits <= 8) {
+      endgame_entry e = table[a * ENDGAME_LIMIT + b];
+      *pX = e.s;
+      *pY = e.t;
+      *pGcd = static_cast<U>(e.s * a + e.t * b);
+   } else {
+      using P = typename std::common_type<U, unsigned int>::type;
+      S x0=1, y0=0;
+      U a0=a;
+      S x1=0, y1=1;
+      U a1=b;
+      while (((a0 | a1) >> 8) != 0) {
+         if (a1 == 0) {
+            *pX = x0;
+            *pY = y0;
+            *pGcd = a0;
+            return;
+         }
+         U q = a0/a1;
+         U a2 = static_cast<U>(a0 - q*a1);
+         S x2 = x0 - static_cast<S>(q)*x1;
+         S y2 = y0 - static_cast<S>(q)*y1;
+         x0=x1; y0=y1; a0=a1;
+         x1=x2; y1=y2; a1=a2;
+      }
+      endgame_entry e = table[a0 * ENDGAME_LIMIT + a1];
+      // the products may wrap, but the sums are final coefficients, which
+      // fit S, so wrapping arithmetic gives them exactly
+      P s = static_cast<P>(e.s), t = static_cast<P>(e.t);
+      *pX = static_cast<S>(static_cast<U>(s * static_cast<P>(x0) + t * static_cast<P>(x1)));
+      *pY = static_cast<S>(static_cast<U>(s * static_cast<P>(y0) + t * static_cast<P>(y1)));
+      *pGcd = static_cast<U>(s * a0 + t * a1);
+   }
+}
+
+#endif
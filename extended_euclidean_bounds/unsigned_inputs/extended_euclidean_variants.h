@@ -0,0 +1,425 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Alternative scalar implementations of unsigned_extended_euclidean().  Each
+// has the same interface, and for all inputs returns results identical to
+// those of unsigned_extended_euclidean(); they differ only in how they get
+// there, and so in which microarchitectures and input widths they suit:
+//
+//   small_quotient_extended_euclidean   Finds quotients of 1, 2 and 3 (about
+//        70% of all quotients for random inputs) by subtraction, and divides
+//        only for larger ones.  Suits CPUs with a slow divider.
+//   fp_reciprocal_extended_euclidean    Computes each quotient by a double
+//        precision division, with a one-step correction, for dividends of at
+//        most 53 bits; larger dividends use integer division.  Suits CPUs
+//        whose FP divider is much faster than the integer one.
+//   binary_extended_euclidean           Stein's binary algorithm: shifts and
+//        subtractions only.  It finds the coefficients modulo b/gcd (or
+//        a/gcd), normalizes them to the Euclidean ones, and divides exactly
+//        by multiplying with an inverse modulo 2^N; no division instruction
+//        is used at all.
+//   lehmer_extended_euclidean           Lehmer's algorithm (Knuth's
+//        Algorithm L): simulates a run of Euclidean steps on the leading half
+//        of the bits, and applies the steps to the full values at once.
+//   width_descending_extended_euclidean The plain loop, but the remainders
+//        move to 32-bit and then 16-bit variables as soon as they fit, so
+//        that the divisions get narrower (a 32-bit div is 2-3x faster than a
+//        64-bit one on many x86 cores).  The coefficients stay at full width.
+//   deferred_y_extended_euclidean       The plain loop without the y
+//        recurrence; afterwards y = (gcd - a*x)/b, by a widening multiply and
+//        an exact division (a shift, and a multiply by an inverse modulo
+//        2^N).  For 64-bit inputs this needs unsigned __int128; without it,
+//        the plain loop is used.
+//
+// The binary variant relies on the fact that the Euclidean coefficients are
+// the unique ones with |x| < b/(2*gcd) and |y| < a/(2*gcd) when those bounds
+// exceed 1 (the cases where a or b divides the other are handled directly).
+
+#ifndef EXTENDED_EUCLIDEAN_VARIANTS
+#define EXTENDED_EUCLIDEAN_VARIANTS 1
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+
+template <class S, class U>
+void small_quotient_extended_euclidean(const U a, const U b, U* pGcd, S* pX, S* pY)
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+   S x0=1, y0=0;
+   U a0=a;
+   S x1=0, y1=1;
+   U a1=b;
+
+   while (a1 != 0) {
+      U q, a2;
+      if (a0 < a1) {
+         q = 0;
+         a2 = a0;
+      } else if ((a2 = static_cast<U>(a0 - a1)) < a1) {
+         q = 1;
+      } else if ((a2 = static_cast<U>(a2 - a1)) < a1) {
+         q = 2;
+      } else if ((a2 = static_cast<U>(a2 - a1)) < a1) {
+         q = 3;
+      } else {
+         q = a0/a1;
+         a2 = static_cast<U>(a0 - q*a1);
+      }
+      S x2 = x0 - static_cast<S>(q)*x1;
+      S y2 = y0 - static_cast<S>(q)*y1;
+      x0=x1; y0=y1; a0=a1;
+      x1=x2; y1=y2; a1=a2;
+   }
+   *pX = x0;
+   *pY = y0;
+   *pGcd = a0;
+}
+
+
+// Returns a0/a1 and sets *pRemainder to a0 - (a0/a1)*a1, for a1 != 0.  For
+// a0, a1 < 2^53 both convert to double exactly, and the correctly rounded
+// quotient is at least the true one (the floor of an integer quotient is
+// exact) and at most one greater; for inputs of at most 32 bits it's never
+// greater.  Larger inputs use integer division.
+template <class U>
+inline U fp_reciprocal_quotient(U a0, U a1, U* pRemainder)
+{
+   if constexpr (std::numeric_limits<U>::digits > 53) {
+      if (((a0 | a1) >> 53) != 0) {
+         U q = a0/a1;
+         *pRemainder = static_cast<U>(a0 - q*a1);
+         return q;
+      }
+   }
+   double quotient = static_cast<double>(static_cast<int64_t>(a0)) /
+                     static_cast<double>(static_cast<int64_t>(a1));
+   U q = static_cast<U>(static_cast<int64_t>(quotient));
+   U r = static_cast<U>(a0 - q*a1);
+   if (r > a0) {   // q was one too large, and the subtraction wrapped
+      --q;
+      r = static_cast<U>(r + a1);
+   }
+   *pRemainder = r;
+   return q;
+}
+
+template <class S, class U>
+void fp_reciprocal_extended_euclidean(const U a, const U b, U* pGcd, S* pX, S* pY)
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+   static_assert(std::numeric_limits<U>::digits <= 64, "");
+   S x0=1, y0=0;
+   U a0=a;
+   S x1=0, y1=1;
+   U a1=b;
+
+   while (a1 != 0) {
+      U a2;
+      U q = fp_reciprocal_quotient(a0, a1, &a2);
+      S x2 = x0 - static_cast<S>(q)*x1;
+      S y2 = y0 - static_cast<S>(q)*y1;
+      x0=x1; y0=y1; a0=a1;
+      x1=x2; y1=y2; a1=a2;
+   }
+   *pX = x0;
+   *pY = y0;
+   *pGcd = a0;
+}
+
+
+// The inverse of odd d modulo 2^N, where N is the number of bits of U, by
+// Newton-Hensel iteration: (3*d) ^ 2 is the inverse modulo 2^5, and each step
+// inv*(2 - d*inv) doubles the number of correct low bits, so N == 8, 16, 32,
+// 64 and 128 take 1, 2, 3, 4 and 5 steps of two multiplies each, with no
+// division.
+template <class U>
+constexpr U inverse_mod_word(U d)
+{
+   using P = typename std::common_type<U, unsigned int>::type;   // no int promotion
+   P inv = (3u * static_cast<P>(d)) ^ 2u;
+   for (int bits = 5; bits < std::numeric_limits<U>::digits; bits *= 2)
+      inv = inv * (2u - static_cast<P>(d) * inv);
+   return static_cast<U>(inv);
+}
+
+// The inverse of u modulo odd m >= 3, for u coprime to m, by the binary
+// algorithm; the result is in [0, m).
+template <class U>
+U binary_inverse(U u, U m)
+{
+   auto half = [m](U x) {   // x/2 modulo m
+         return (x & 1) ? static_cast<U>((x >> 1) + (m >> 1) + 1)
+                        : static_cast<U>(x >> 1);
+      };
+   // invariants: u == base*x1 and v == base*x2 (mod m), with base the input u
+   U v = m, x1 = 1, x2 = 0;
+   while ((u & 1) == 0) {
+      u >>= 1;
+      x1 = half(x1);
+   }
+   while (u != v) {
+      if (u > v) {
+         u = static_cast<U>(u - v);
+         x1 = (x1 >= x2) ? static_cast<U>(x1 - x2) : static_cast<U>(x1 + (m - x2));
+         do {
+            u >>= 1;
+            x1 = half(x1);
+         } while ((u & 1) == 0);
+      } else {
+         v = static_cast<U>(v - u);
+         x2 = (x2 >= x1) ? static_cast<U>(x2 - x1) : static_cast<U>(x2 + (m - x1));
+         do {
+            v >>= 1;
+            x2 = half(x2);
+         } while ((v & 1) == 0);
+      }
+   }
+   return x1;
+}
+
+template <class S, class U>
+void binary_extended_euclidean(const U a, const U b, U* pGcd, S* pX, S* pY)
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+   using P = typename std::common_type<U, unsigned int>::type;
+   if (b == 0) {
+      *pGcd = a; *pX = 1; *pY = 0;
+      return;
+   }
+   if (a == 0) {
+      *pGcd = b; *pX = 0; *pY = 1;
+      return;
+   }
+   // Stein's gcd; then a/gcd and b/gcd by exact division
+   int shift = std::countr_zero(static_cast<U>(a | b));
+   U u = static_cast<U>(a >> std::countr_zero(a));
+   U v = static_cast<U>(b >> std::countr_zero(b));
+   while (u != v) {
+      if (u > v) {
+         U t = u; u = v; v = t;
+      }
+      v = static_cast<U>(v - u);
+      v = static_cast<U>(v >> std::countr_zero(v));
+   }
+   U gcd = static_cast<U>(u << shift);
+   U oddInverse = inverse_mod_word(u);
+   U A = static_cast<U>(static_cast<P>(a >> shift) * oddInverse);
+   U B = static_cast<U>(static_cast<P>(b >> shift) * oddInverse);
+   *pGcd = gcd;
+
+   // A*x + B*y == 1 now determines the coefficients
+   if (B == 1) {
+      *pX = 0; *pY = 1;
+   } else if (A == 1) {
+      *pX = 1; *pY = 0;
+   } else if (B & 1) {
+      U x = binary_inverse(A, B);
+      if (x > B - x)
+         x = static_cast<U>(x - B);   // now -B/2 < x < B/2, modulo 2^N
+      U y = static_cast<U>((1u - static_cast<P>(A) * x) * inverse_mod_word(B));
+      *pX = static_cast<S>(x);
+      *pY = static_cast<S>(y);
+   } else {
+      // B is even, so A is odd (and at least 3)
+      U y = binary_inverse(B, A);
+      if (y > A - y)
+         y = static_cast<U>(y - A);
+      U x = static_cast<U>((1u - static_cast<P>(B) * y) * inverse_mod_word(A));
+      *pX = static_cast<S>(x);
+      *pY = static_cast<S>(y);
+   }
+}
+
+
+template <class S, class U>
+void lehmer_extended_euclidean(const U a, const U b, U* pGcd, S* pX, S* pY)
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+   static_assert(std::numeric_limits<U>::digits <= 64, "");
+   using P = typename std::common_type<U, unsigned int>::type;
+   constexpr int HALF = std::numeric_limits<U>::digits / 2;
+   // The coefficients are kept modulo 2^N: the matrix products below may
+   // wrap, but their true values are Euclidean coefficients, which fit S.
+   P x0=1, y0=0;
+   U a0=a;
+   P x1=0, y1=1;
+   U a1=b;
+
+   while (a1 != 0) {
+      // simulate Euclidean steps on the leading HALF bits of a0 and a1
+      int64_t A = 1, B = 0, C = 0, D = 1;
+      if (a0 >= a1 && (a0 >> HALF) != 0) {
+         int shift = std::bit_width(a0) - HALF;
+         int64_t ah = static_cast<int64_t>(a0 >> shift);
+         int64_t bh = static_cast<int64_t>(a1 >> shift);
+         while (bh + C != 0 && bh + D != 0) {
+            int64_t q = (ah + A) / (bh + C);
+            if (q != (ah + B) / (bh + D))
+               break;
+            int64_t t = A - q*C; A = C; C = t;
+            t = B - q*D; B = D; D = t;
+            t = ah - q*bh; ah = bh; bh = t;
+         }
+      }
+      if (B == 0) {
+         // no step could be simulated: one full precision step
+         U q = a0/a1;
+         U a2 = static_cast<U>(a0 - q*a1);
+         P x2 = x0 - q*x1;
+         P y2 = y0 - q*y1;
+         x0=x1; y0=y1; a0=a1;
+         x1=x2; y1=y2; a1=a2;
+      } else {
+         P pA = static_cast<P>(A), pB = static_cast<P>(B);
+         P pC = static_cast<P>(C), pD = static_cast<P>(D);
+         U a2 = static_cast<U>(pA*a0 + pB*a1);
+         U a3 = static_cast<U>(pC*a0 + pD*a1);
+         P x2 = pA*x0 + pB*x1, x3 = pC*x0 + pD*x1;
+         P y2 = pA*y0 + pB*y1, y3 = pC*y0 + pD*y1;
+         x0=x2; y0=y2; a0=a2;
+         x1=x3; y1=y3; a1=a3;
+      }
+   }
+   *pX = static_cast<S>(static_cast<U>(x0));
+   *pY = static_cast<S>(static_cast<U>(y0));
+   *pGcd = a0;
+}
+
+
+// Euclidean steps on a0, a1 (in type N) while either exceeds narrowBits
+// bits, or to the end if narrowBits is N's width.
+template <int narrowBits, class S, class N>
+inline void width_descending_steps(N& a0, N& a1, S& x0, S& y0, S& x1, S& y1)
+{
+   while (a1 != 0) {
+      if constexpr (narrowBits < std::numeric_limits<N>::digits) {
+         if (((a0 | a1) >> narrowBits) == 0)
+            return;
+      }
+      N q = static_cast<N>(a0/a1);
+      N a2 = static_cast<N>(a0 - q*a1);
+      S x2 = x0 - static_cast<S>(q)*x1;
+      S y2 = y0 - static_cast<S>(q)*y1;
+      x0=x1; y0=y1; a0=a1;
+      x1=x2; y1=y2; a1=a2;
+   }
+}
+
+template <class S, class U>
+void width_descending_extended_euclidean(const U a, const U b, U* pGcd, S* pX, S* pY)
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+   static_assert(std::numeric_limits<U>::digits <= 64, "");
+   S x0=1, y0=0;
+   S x1=0, y1=1;
+   U gcd;
+   // each stage ends either with the gcd found, or with both remainders
+   // narrow enough for the next stage
+   U a0=a, a1=b;
+   if constexpr (std::numeric_limits<U>::digits > 32)
+      width_descending_steps<32>(a0, a1, x0, y0, x1, y1);
+   if (a1 == 0) {
+      gcd = a0;
+   } else {
+      using N32 = typename std::conditional<(std::numeric_limits<U>::digits > 32),
+                                            uint32_t, U>::type;
+      N32 b0 = static_cast<N32>(a0), b1 = static_cast<N32>(a1);
+      if constexpr (std::numeric_limits<N32>::digits > 16)
+         width_descending_steps<16>(b0, b1, x0, y0, x1, y1);
+      if (b1 == 0) {
+         gcd = b0;
+      } else {
+         using N16 = typename std::conditional<(std::numeric_limits<N32>::digits > 16),
+                                               uint16_t, N32>::type;
+         N16 c0 = static_cast<N16>(b0), c1 = static_cast<N16>(b1);
+         width_descending_steps<std::numeric_limits<N16>::digits>(c0, c1, x0, y0,
+                                                                  x1, y1);
+         gcd = c0;
+      }
+   }
+   *pX = x0;
+   *pY = y0;
+   *pGcd = gcd;
+}
+
+
+// a signed type of at least twice the width of U, or void if there is none
+template <class U, bool = (std::numeric_limits<U>::digits <= 32)>
+struct deferred_y_wide_type {
+   using type = int64_t;
+};
+template <class U>
+struct deferred_y_wide_type<U, false> {
+#if defined(__SIZEOF_INT128__)
+   using type = __int128;
+#else
+   using type = void;
+#endif
+};
+
+template <class S, class U>
+void deferred_y_extended_euclidean(const U a, const U b, U* pGcd, S* pX, S* pY)
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+   static_assert(std::numeric_limits<U>::digits <= 64, "");
+   using W = typename deferred_y_wide_type<U>::type;
+   if constexpr (std::is_void<W>::value) {
+      unsigned_extended_euclidean<S, U>(a, b, pGcd, pX, pY);
+   } else {
+      using P = typename std::common_type<U, unsigned int>::type;
+      S x0=1;
+      U a0=a;
+      S x1=0;
+      U a1=b;
+      while (a1 != 0) {
+         U q = a0/a1;
+         U a2 = static_cast<U>(a0 - q*a1);
+         S x2 = x0 - static_cast<S>(q)*x1;
+         x0=x1; a0=a1;
+         x1=x2; a1=a2;
+      }
+      *pX = x0;
+      *pGcd = a0;
+      if (b == 0) {
+         *pY = 0;   // and x0 == 1
+         return;
+      }
+      // gcd - a*x == b*y exactly, so with b == 2^k * m for odd m, shifting
+      // right by k leaves m*y, whose low N bits times the inverse of m
+      // modulo 2^N are y (which fits S, by the final bounds)
+      int k = std::countr_zero(b);
+      W t = static_cast<W>(a0) - static_cast<W>(a) * static_cast<W>(x0);
+      U my = static_cast<U>(t >> k);
+      U m = static_cast<U>(b >> k);
+      *pY = static_cast<S>(static_cast<U>(static_cast<P>(my) * inverse_mod_word(m)));
+   }
+}
+
+#endif
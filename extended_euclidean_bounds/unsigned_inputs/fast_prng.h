@@ -0,0 +1,92 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// A small, fast pseudo-random number generator for the randomized tests:
+// xoshiro256** (Blackman and Vigna), seeded through splitmix64.  jump()
+// advances a generator by 2^128 steps, so that generator k of a test can be
+// created as (seed, jumped k times), giving every thread its own
+// non-overlapping stream that is reproducible from the seed alone.
+
+#ifndef FAST_PRNG
+#define FAST_PRNG 1
+
+#include <cstdint>
+
+
+inline uint64_t splitmix64(uint64_t* pState)
+{
+   uint64_t z = (*pState += 0x9E3779B97F4A7C15u);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+   return z ^ (z >> 31);
+}
+
+
+class xoshiro256ss {
+   uint64_t s[4];
+
+   static uint64_t rotl(uint64_t x, int k)
+   {
+      return (x << k) | (x >> (64 - k));
+   }
+public:
+   explicit xoshiro256ss(uint64_t seed)
+   {
+      for (int i = 0; i < 4; ++i)
+         s[i] = splitmix64(&seed);
+   }
+
+   // the stream for thread (or worker) number 'stream' of a given seed
+   xoshiro256ss(uint64_t seed, unsigned int stream) : xoshiro256ss(seed)
+   {
+      for (unsigned int i = 0; i < stream; ++i)
+         jump();
+   }
+
+   uint64_t next()
+   {
+      const uint64_t result = rotl(s[1] * 5, 7) * 9;
+      const uint64_t t = s[1] << 17;
+      s[2] ^= s[0];
+      s[3] ^= s[1];
+      s[1] ^= s[2];
+      s[0] ^= s[3];
+      s[2] ^= t;
+      s[3] = rotl(s[3], 45);
+      return result;
+   }
+
+   // a value with a uniformly chosen bit length in [0, maxLength], and random
+   // bits below its leading bit
+   uint64_t next_random_length(int maxLength = 64)
+   {
+      uint64_t r = next();
+      int length = static_cast<int>(r % static_cast<uint64_t>(maxLength + 1));
+      if (length == 0)
+         return 0;
+      uint64_t value = next() >> (64 - length);
+      return value | (static_cast<uint64_t>(1) << (length - 1));
+   }
+
+   void jump()
+   {
+      static const uint64_t JUMP[] = { 0x180EC6D33CFD0ABAu,
+                                       0xD5A61266F0C9392Cu,
+                                       0xA9582618E03FC9AAu,
+                                       0x39ABDC4529B1661Cu };
+      uint64_t t[4] = { 0, 0, 0, 0 };
+      for (uint64_t jump : JUMP) {
+         for (int b = 0; b < 64; ++b) {
+            if (jump & (static_cast<uint64_t>(1) << b)) {
+               for (int i = 0; i < 4; ++i)
+                  t[i] ^= s[i];
+            }
+            next();
+         }
+      }
+      for (int i = 0; i < 4; ++i)
+         s[i] = t[i];
+   }
+};
+
+#endif
@@ -0,0 +1,391 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Fixed width integers of LIMBS 64-bit limbs, for widths beyond the native
+// ones (256 bits, for example): fixed_uint<LIMBS> is unsigned and
+// fixed_int<LIMBS> is its two's complement signed counterpart.  Both wrap
+// modulo 2^(64*LIMBS), like the native unsigned types; the signed type
+// differs only in comparisons, right shifts, division and numeric_limits.
+// Division is Knuth's Algorithm D (TAOCP vol. 2, 4.3.1) on 64-bit digits.
+//
+// std::make_signed can't be specialized for class types, so the engines that
+// assert make_signed<U> == S don't instantiate with these;
+// fixed_width_extended_euclidean() below is the plain loop of
+// unsigned_extended_euclidean() for them.  Needs unsigned __int128; without
+// it (on MSVC, for example) the header defines nothing.
+
+#ifndef FIXED_WIDTH_INTEGER
+#define FIXED_WIDTH_INTEGER 1
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+#include <assert.h>
+
+#ifdef __SIZEOF_INT128__
+
+template <int LIMBS, bool SIGNED>
+class fixed_width_integer {
+   static_assert(LIMBS >= 1, "");
+   using u128 = unsigned __int128;
+public:
+   uint64_t limb[LIMBS];   // least significant first
+
+   constexpr fixed_width_integer() : limb{} {}
+   template <class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+   constexpr fixed_width_integer(T v) : limb{}
+   {
+      limb[0] = static_cast<uint64_t>(v);
+      uint64_t extension = 0;
+      if constexpr (std::is_signed<T>::value)
+         extension = (v < 0) ? ~uint64_t(0) : 0;
+      for (int i = 1; i < LIMBS; ++i)
+         limb[i] = extension;
+   }
+   constexpr explicit fixed_width_integer(const fixed_width_integer<LIMBS, !SIGNED>& v)
+   {
+      for (int i = 0; i < LIMBS; ++i)
+         limb[i] = v.limb[i];
+   }
+   // the low bits, like a conversion between native integer types
+   template <class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+   constexpr explicit operator T() const { return static_cast<T>(limb[0]); }
+   constexpr explicit operator bool() const { return !is_zero(); }
+
+   constexpr bool is_zero() const
+   {
+      uint64_t any = 0;
+      for (int i = 0; i < LIMBS; ++i)
+         any |= limb[i];
+      return any == 0;
+   }
+   constexpr bool is_negative() const
+   {
+      return SIGNED && (limb[LIMBS - 1] >> 63) != 0;
+   }
+
+   friend constexpr fixed_width_integer operator+(const fixed_width_integer& a,
+                                                  const fixed_width_integer& b)
+   {
+      fixed_width_integer r;
+      uint64_t carry = 0;
+      for (int i = 0; i < LIMBS; ++i) {
+         u128 s = static_cast<u128>(a.limb[i]) + b.limb[i] + carry;
+         r.limb[i] = static_cast<uint64_t>(s);
+         carry = static_cast<uint64_t>(s >> 64);
+      }
+      return r;
+   }
+   friend constexpr fixed_width_integer operator-(const fixed_width_integer& a,
+                                                  const fixed_width_integer& b)
+   {
+      fixed_width_integer r;
+      uint64_t borrow = 0;
+      for (int i = 0; i < LIMBS; ++i) {
+         u128 d = static_cast<u128>(a.limb[i]) - b.limb[i] - borrow;
+         r.limb[i] = static_cast<uint64_t>(d);
+         borrow = static_cast<uint64_t>(d >> 64) & 1;
+      }
+      return r;
+   }
+   friend constexpr fixed_width_integer operator-(const fixed_width_integer& a)
+   {
+      return fixed_width_integer() - a;
+   }
+   // the low half of the product, so the same for signed and unsigned; every
+   // limb is multiplied, zero or not, so that the time doesn't depend on
+   // the values
+   friend constexpr fixed_width_integer operator*(const fixed_width_integer& a,
+                                                  const fixed_width_integer& b)
+   {
+      fixed_width_integer r;
+      for (int i = 0; i < LIMBS; ++i) {
+         uint64_t carry = 0;
+         for (int j = 0; i + j < LIMBS; ++j) {
+            u128 p = static_cast<u128>(a.limb[i]) * b.limb[j] + r.limb[i + j] + carry;
+            r.limb[i + j] = static_cast<uint64_t>(p);
+            carry = static_cast<uint64_t>(p >> 64);
+         }
+      }
+      return r;
+   }
+   // truncates toward zero, like the native types
+   friend constexpr fixed_width_integer operator/(const fixed_width_integer& a,
+                                                  const fixed_width_integer& b)
+   {
+      fixed_width_integer q, r;
+      divide(a, b, &q, &r);
+      return q;
+   }
+   friend constexpr fixed_width_integer operator%(const fixed_width_integer& a,
+                                                  const fixed_width_integer& b)
+   {
+      fixed_width_integer q, r;
+      divide(a, b, &q, &r);
+      return r;
+   }
+
+   friend constexpr fixed_width_integer operator&(fixed_width_integer a,
+                                                  const fixed_width_integer& b)
+   {
+      for (int i = 0; i < LIMBS; ++i)
+         a.limb[i] &= b.limb[i];
+      return a;
+   }
+   friend constexpr fixed_width_integer operator|(fixed_width_integer a,
+                                                  const fixed_width_integer& b)
+   {
+      for (int i = 0; i < LIMBS; ++i)
+         a.limb[i] |= b.limb[i];
+      return a;
+   }
+   friend constexpr fixed_width_integer operator^(fixed_width_integer a,
+                                                  const fixed_width_integer& b)
+   {
+      for (int i = 0; i < LIMBS; ++i)
+         a.limb[i] ^= b.limb[i];
+      return a;
+   }
+   friend constexpr fixed_width_integer operator~(fixed_width_integer a)
+   {
+      for (int i = 0; i < LIMBS; ++i)
+         a.limb[i] = ~a.limb[i];
+      return a;
+   }
+   friend constexpr fixed_width_integer operator<<(const fixed_width_integer& a, int n)
+   {
+      assert(0 <= n && n < 64 * LIMBS);
+      fixed_width_integer r;
+      int words = n / 64, bits = n % 64;
+      for (int i = LIMBS - 1; i >= words; --i) {
+         uint64_t v = a.limb[i - words] << bits;
+         if (bits != 0 && i - words - 1 >= 0)
+            v |= a.limb[i - words - 1] >> (64 - bits);
+         r.limb[i] = v;
+      }
+      return r;
+   }
+   // arithmetic for the signed type, logical for the unsigned one
+   friend constexpr fixed_width_integer operator>>(const fixed_width_integer& a, int n)
+   {
+      assert(0 <= n && n < 64 * LIMBS);
+      uint64_t extension = uint64_t(0) - static_cast<uint64_t>(a.is_negative());
+      fixed_width_integer r;
+      int words = n / 64, bits = n % 64;
+      for (int i = 0; i < LIMBS; ++i) {
+         uint64_t lo = (i + words < LIMBS) ? a.limb[i + words] : extension;
+         uint64_t hi = (i + words + 1 < LIMBS) ? a.limb[i + words + 1] : extension;
+         r.limb[i] = (bits == 0) ? lo : (lo >> bits) | (hi << (64 - bits));
+      }
+      return r;
+   }
+
+   friend constexpr bool operator==(const fixed_width_integer& a,
+                                    const fixed_width_integer& b)
+   {
+      return (a ^ b).is_zero();
+   }
+   friend constexpr bool operator!=(const fixed_width_integer& a,
+                                    const fixed_width_integer& b)
+   {
+      return !(a == b);
+   }
+   // the borrow out of a - b, without branches; for the signed type,
+   // flipping the sign bits maps the order onto the unsigned one
+   friend constexpr bool operator<(const fixed_width_integer& a,
+                                   const fixed_width_integer& b)
+   {
+      uint64_t borrow = 0;
+      for (int i = 0; i < LIMBS; ++i) {
+         uint64_t flip = (SIGNED && i == LIMBS - 1) ? uint64_t(1) << 63 : 0;
+         u128 d = static_cast<u128>(a.limb[i] ^ flip) - (b.limb[i] ^ flip) - borrow;
+         borrow = static_cast<uint64_t>(d >> 64) & 1;
+      }
+      return borrow != 0;
+   }
+   friend constexpr bool operator>(const fixed_width_integer& a,
+                                   const fixed_width_integer& b) { return b < a; }
+   friend constexpr bool operator<=(const fixed_width_integer& a,
+                                    const fixed_width_integer& b) { return !(b < a); }
+   friend constexpr bool operator>=(const fixed_width_integer& a,
+                                    const fixed_width_integer& b) { return !(a < b); }
+
+   constexpr fixed_width_integer& operator+=(const fixed_width_integer& b) { return *this = *this + b; }
+   constexpr fixed_width_integer& operator-=(const fixed_width_integer& b) { return *this = *this - b; }
+   constexpr fixed_width_integer& operator*=(const fixed_width_integer& b) { return *this = *this * b; }
+   constexpr fixed_width_integer& operator/=(const fixed_width_integer& b) { return *this = *this / b; }
+   constexpr fixed_width_integer& operator%=(const fixed_width_integer& b) { return *this = *this % b; }
+   constexpr fixed_width_integer& operator&=(const fixed_width_integer& b) { return *this = *this & b; }
+   constexpr fixed_width_integer& operator|=(const fixed_width_integer& b) { return *this = *this | b; }
+   constexpr fixed_width_integer& operator^=(const fixed_width_integer& b) { return *this = *this ^ b; }
+   constexpr fixed_width_integer& operator<<=(int n) { return *this = *this << n; }
+   constexpr fixed_width_integer& operator>>=(int n) { return *this = *this >> n; }
+
+   // hexadecimal, with a sign for negative values of the signed type
+   friend std::ostream& operator<<(std::ostream& os, const fixed_width_integer& v)
+   {
+      fixed_width_integer<LIMBS, false> m(v.is_negative() ? -v : v);
+      static const char digits[] = "0123456789abcdef";
+      char buf[16 * LIMBS + 1];
+      int n = 0;
+      do {
+         buf[n++] = digits[m.limb[0] & 15];
+         m >>= 4;
+      } while (!m.is_zero());
+      os << (v.is_negative() ? "-0x" : "0x");
+      while (n > 0)
+         os << buf[--n];
+      return os;
+   }
+
+private:
+   // unsigned division with remainder, by Knuth's Algorithm D
+   static constexpr void divide_unsigned(const fixed_width_integer& u,
+                                         const fixed_width_integer& v,
+                                         fixed_width_integer* pQ,
+                                         fixed_width_integer* pR)
+   {
+      int n = LIMBS, m = LIMBS;
+      while (n > 0 && v.limb[n - 1] == 0)
+         --n;
+      while (m > 0 && u.limb[m - 1] == 0)
+         --m;
+      assert(n > 0);   // division by zero
+      *pQ = fixed_width_integer();
+      *pR = fixed_width_integer();
+      if (m < n) {
+         *pR = u;
+         return;
+      }
+      if (n == 1) {
+         uint64_t rem = 0;
+         for (int i = m - 1; i >= 0; --i) {
+            u128 cur = (static_cast<u128>(rem) << 64) | u.limb[i];
+            pQ->limb[i] = static_cast<uint64_t>(cur / v.limb[0]);
+            rem = static_cast<uint64_t>(cur % v.limb[0]);
+         }
+         pR->limb[0] = rem;
+         return;
+      }
+      // D1: normalize so that the divisor's top digit has its top bit set
+      int s = std::countl_zero(v.limb[n - 1]);
+      uint64_t vn[LIMBS] = {}, un[LIMBS + 1] = {};
+      for (int i = n - 1; i > 0; --i)
+         vn[i] = (v.limb[i] << s) | (s ? v.limb[i - 1] >> (64 - s) : 0);
+      vn[0] = v.limb[0] << s;
+      un[m] = s ? u.limb[m - 1] >> (64 - s) : 0;
+      for (int i = m - 1; i > 0; --i)
+         un[i] = (u.limb[i] << s) | (s ? u.limb[i - 1] >> (64 - s) : 0);
+      un[0] = u.limb[0] << s;
+
+      for (int j = m - n; j >= 0; --j) {
+         // D3: estimate the quotient digit, which is then at most 1 too large
+         u128 num = (static_cast<u128>(un[j + n]) << 64) | un[j + n - 1];
+         u128 qhat = num / vn[n - 1];
+         u128 rhat = num % vn[n - 1];
+         while ((qhat >> 64) != 0 ||
+                qhat * vn[n - 2] > ((rhat << 64) | un[j + n - 2])) {
+            --qhat;
+            rhat += vn[n - 1];
+            if ((rhat >> 64) != 0)
+               break;
+         }
+         // D4: multiply and subtract
+         uint64_t borrow = 0, carry = 0;
+         for (int i = 0; i < n; ++i) {
+            u128 p = qhat * vn[i] + carry;
+            carry = static_cast<uint64_t>(p >> 64);
+            u128 d = static_cast<u128>(un[i + j]) - static_cast<uint64_t>(p) - borrow;
+            un[i + j] = static_cast<uint64_t>(d);
+            borrow = static_cast<uint64_t>(d >> 64) & 1;
+         }
+         u128 d = static_cast<u128>(un[j + n]) - carry - borrow;
+         un[j + n] = static_cast<uint64_t>(d);
+         pQ->limb[j] = static_cast<uint64_t>(qhat);
+         // D6: add back, if the estimate was too large
+         if (((d >> 64) & 1) != 0) {
+            --pQ->limb[j];
+            uint64_t c = 0;
+            for (int i = 0; i < n; ++i) {
+               u128 t = static_cast<u128>(un[i + j]) + vn[i] + c;
+               un[i + j] = static_cast<uint64_t>(t);
+               c = static_cast<uint64_t>(t >> 64);
+            }
+            un[j + n] += c;
+         }
+      }
+      // D8: unnormalize the remainder
+      for (int i = 0; i < n; ++i)
+         pR->limb[i] = (un[i] >> s) | (s ? un[i + 1] << (64 - s) : 0);
+   }
+
+   static constexpr void divide(const fixed_width_integer& a,
+                                const fixed_width_integer& b,
+                                fixed_width_integer* pQ, fixed_width_integer* pR)
+   {
+      bool negA = a.is_negative(), negB = b.is_negative();
+      divide_unsigned(negA ? -a : a, negB ? -b : b, pQ, pR);
+      if (negA != negB)
+         *pQ = -*pQ;
+      if (negA)
+         *pR = -*pR;
+   }
+};
+
+template <int LIMBS>
+using fixed_uint = fixed_width_integer<LIMBS, false>;
+template <int LIMBS>
+using fixed_int = fixed_width_integer<LIMBS, true>;
+
+
+namespace std {
+template <int LIMBS, bool SIGNED>
+class numeric_limits<fixed_width_integer<LIMBS, SIGNED>> {
+   using T = fixed_width_integer<LIMBS, SIGNED>;
+public:
+   static constexpr bool is_specialized = true;
+   static constexpr bool is_integer = true;
+   static constexpr bool is_signed = SIGNED;
+   static constexpr bool is_exact = true;
+   static constexpr bool is_modulo = !SIGNED;
+   static constexpr int radix = 2;
+   static constexpr int digits = 64 * LIMBS - (SIGNED ? 1 : 0);
+   static constexpr T min() { return SIGNED ? T(1) << (64 * LIMBS - 1) : T(0); }
+   static constexpr T max() { return ~min(); }
+   static constexpr T lowest() { return min(); }
+};
+}
+
+
+// unsigned_extended_euclidean(), for fixed_uint inputs
+template <int LIMBS>
+void fixed_width_extended_euclidean(const fixed_uint<LIMBS> a,
+                                    const fixed_uint<LIMBS> b,
+                                    fixed_uint<LIMBS>* pGcd,
+                                    fixed_int<LIMBS>* pX, fixed_int<LIMBS>* pY)
+{
+   using S = fixed_int<LIMBS>;
+   using U = fixed_uint<LIMBS>;
+   S x0=1, y0=0;
+   U a0=a;
+   S x1=0, y1=1;
+   U a1=b;
+
+   while (a1 != 0) {
+      U q = a0/a1;
+      U a2 = a0 - q*a1;
+      S x2 = x0 - static_cast<S>(q)*x1;
+      S y2 = y0 - static_cast<S>(q)*y1;
+      x0=x1; y0=y1; a0=a1;
+      x1=x2; y1=y2; a1=a2;
+   }
+   *pX = x0;
+   *pY = y0;
+   *pGcd = a0;
+}
+
+#endif
+
+#endif
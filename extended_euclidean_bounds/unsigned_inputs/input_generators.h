@@ -0,0 +1,375 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Generators of (a, b) input pairs that stress the Extended Euclidean
+// algorithm, for use by the tests and benchmarks.  Every generator keeps O(1)
+// state and produces its pairs one at a time through
+//    bool next(T* pA, T* pB)
+// which returns false once the generator is exhausted (reset() restarts it),
+// so a caller can stream any number of pairs without storing them.
+//
+// T may be any signed or unsigned integer type; all generated values are in
+// the range [0, std::numeric_limits<T>::max()], which satisfies the a >= 0
+// and b >= 0 preconditions of the signed functions.
+//
+//   fibonacci_pairs          consecutive Fibonacci numbers (the inputs that
+//                            need the most loop iterations for their size)
+//   large_quotient_pairs     pairs with one huge quotient, q*b + r with b small
+//   large_gcd_pairs          g*u, g*v with small coprime u, v and g large
+//   near_power_of_two_pairs  2^i + {-1,0,1} against 2^j + {-1,0,1}
+//   scaled_pairs<G>          the pairs of generator G scaled by common factors
+//   random_pairs             uniform or random-bit-length pseudo-random pairs
+//   adversarial_pairs        all of the deterministic generators above in turn
+
+#ifndef INPUT_GENERATORS
+#define INPUT_GENERATORS 1
+
+#include "fast_prng.h"
+#include <limits>
+#include <cstdint>
+
+
+// consecutive Fibonacci pairs (F(k+1), F(k)), each followed by the swapped
+// pair (F(k), F(k+1)) if bothOrders is true, for all F(k+1) that fit in T.
+template <class T>
+class fibonacci_pairs {
+   static_assert(std::numeric_limits<T>::is_integer, "");
+   T f0, f1;
+   bool bothOrders, pendingSwap, done;
+public:
+   explicit fibonacci_pairs(bool bothOrders = true) : bothOrders(bothOrders)
+   {
+      reset();
+   }
+   void reset()
+   {
+      f0 = 0; f1 = 1;
+      pendingSwap = false;
+      done = false;
+   }
+   bool next(T* pA, T* pB)
+   {
+      if (done)
+         return false;
+      if (pendingSwap) {
+         pendingSwap = false;
+         *pA = f0;
+         *pB = f1;
+         advance();
+         return true;
+      }
+      *pA = f1;
+      *pB = f0;
+      if (bothOrders)
+         pendingSwap = true;
+      else
+         advance();
+      return true;
+   }
+private:
+   void advance()
+   {
+      if (f1 > std::numeric_limits<T>::max() - f0) {
+         done = true;
+         return;
+      }
+      T f2 = static_cast<T>(f0 + f1);
+      f0 = f1;
+      f1 = f2;
+   }
+};
+
+
+// Pairs (q*b + r, b) whose first quotient q is as large as T allows, for
+// divisors b = 1..16 and b = 2^s-1, 2^s, 2^s+1, and remainders r = 0, 1, b-1.
+// Each pair is followed by its swapped pair (b, q*b + r), for which the huge
+// quotient is the second one.
+template <class T>
+class large_quotient_pairs {
+   static_assert(std::numeric_limits<T>::is_integer, "");
+   static constexpr int DIGITS = std::numeric_limits<T>::digits;
+   static constexpr int NUM_SMALL = 16;
+   static constexpr int NUM_DIVISORS = NUM_SMALL + 3 * (DIGITS - 6);
+   int divisorIndex, remainderIndex;
+   bool pendingSwap;
+   T divisor, dividend;
+
+   static T get_divisor(int index)
+   {
+      if (index < NUM_SMALL)
+         return static_cast<T>(index + 1);
+      index -= NUM_SMALL;
+      int shift = 5 + index / 3;
+      T p = static_cast<T>(static_cast<T>(1) << shift);
+      return static_cast<T>(p + (index % 3) - 1);
+   }
+public:
+   large_quotient_pairs() { reset(); }
+   void reset()
+   {
+      divisorIndex = 0;
+      remainderIndex = 0;
+      pendingSwap = false;
+      divisor = 0;
+      dividend = 0;
+   }
+   bool next(T* pA, T* pB)
+   {
+      if (pendingSwap) {
+         pendingSwap = false;
+         *pA = divisor;
+         *pB = dividend;
+         return true;
+      }
+      for (; divisorIndex < NUM_DIVISORS; ++divisorIndex, remainderIndex = 0) {
+         T b = get_divisor(divisorIndex);
+         while (remainderIndex < 3) {
+            int index = remainderIndex++;
+            // skip remainders that aren't < b or that repeat an earlier one
+            if ((index == 1 && b <= 1) || (index == 2 && b <= 2))
+               continue;
+            T r = (index == 0) ? 0 : (index == 1) ? 1 : static_cast<T>(b - 1);
+            T q = static_cast<T>((std::numeric_limits<T>::max() - r) / b);
+            divisor = b;
+            dividend = static_cast<T>(q*b + r);
+            pendingSwap = true;
+            *pA = dividend;
+            *pB = divisor;
+            return true;
+         }
+      }
+      return false;
+   }
+};
+
+
+// Pairs (g*u, g*v) for all coprime u, v with 0 <= u, v <= maxCofactor, where g
+// is the largest value for which both products fit in T, or that value minus
+// one, or the largest power of two not above it.
+template <class T>
+class large_gcd_pairs {
+   static_assert(std::numeric_limits<T>::is_integer, "");
+   int maxCofactor, u, v, gcdIndex;
+
+   static int small_gcd(int a, int b)
+   {
+      while (b != 0) {
+         int t = a % b;
+         a = b;
+         b = t;
+      }
+      return a;
+   }
+public:
+   explicit large_gcd_pairs(int maxCofactor = 8) : maxCofactor(maxCofactor)
+   {
+      reset();
+   }
+   void reset()
+   {
+      u = 0; v = 0;
+      gcdIndex = 0;
+   }
+   bool next(T* pA, T* pB)
+   {
+      for (; u <= maxCofactor; ++u, v = 0) {
+         for (; v <= maxCofactor; ++v, gcdIndex = 0) {
+            if (small_gcd(u, v) != 1)
+               continue;
+            int largest = (u > v) ? u : v;
+            T gmax = static_cast<T>(std::numeric_limits<T>::max() /
+                                    static_cast<T>(largest));
+            while (gcdIndex < 3) {
+               T g;
+               if (gcdIndex == 0)
+                  g = gmax;
+               else if (gcdIndex == 1)
+                  g = static_cast<T>(gmax - 1);
+               else {
+                  g = 1;
+                  while (g <= gmax / 2)
+                     g = static_cast<T>(g * 2);
+               }
+               ++gcdIndex;
+               if (g == 0)
+                  continue;
+               *pA = static_cast<T>(g * static_cast<T>(u));
+               *pB = static_cast<T>(g * static_cast<T>(v));
+               return true;
+            }
+         }
+      }
+      return false;
+   }
+};
+
+
+// Pairs (2^i + da, 2^j + db) for all 0 <= i, j < digits(T) and all
+// da, db in {-1, 0, 1}.
+template <class T>
+class near_power_of_two_pairs {
+   static_assert(std::numeric_limits<T>::is_integer, "");
+   static constexpr int DIGITS = std::numeric_limits<T>::digits;
+   int i, j, offsets;
+
+   static T near_power(int shift, int offset)
+   {
+      T p = static_cast<T>(static_cast<T>(1) << shift);
+      return static_cast<T>(p + offset);
+   }
+public:
+   near_power_of_two_pairs() { reset(); }
+   void reset()
+   {
+      i = 0; j = 0;
+      offsets = 0;
+   }
+   bool next(T* pA, T* pB)
+   {
+      if (i >= DIGITS)
+         return false;
+      *pA = near_power(i, offsets / 3 - 1);
+      *pB = near_power(j, offsets % 3 - 1);
+      if (++offsets == 9) {
+         offsets = 0;
+         if (++j == DIGITS) {
+            j = 0;
+            ++i;
+         }
+      }
+      return true;
+   }
+};
+
+
+// The pairs of a base generator multiplied by each of a few common factors
+// (2, 3, 10, and values near 2^max(3,digits/4) and 2^(digits/2)).  Scaled
+// pairs that would overflow T are skipped.
+template <class Generator, class T>
+class scaled_pairs {
+   static_assert(std::numeric_limits<T>::is_integer, "");
+   static constexpr int DIGITS = std::numeric_limits<T>::digits;
+   static constexpr int NUM_FACTORS = 6;
+   // at least 3, so that the factor 2^QUARTER - 1 is 7 rather than 1 or 3
+   // for 8 bit T
+   static constexpr int QUARTER = (DIGITS/4 < 3) ? 3 : DIGITS/4;
+   Generator base;
+   int factorIndex;
+
+   static T get_factor(int index)
+   {
+      switch (index) {
+         case 0: return 2;
+         case 1: return 3;
+         case 2: return 10;
+         case 3: return static_cast<T>((static_cast<T>(1) << QUARTER) - 1);
+         case 4: return static_cast<T>(static_cast<T>(1) << (DIGITS/2));
+         default: return static_cast<T>((static_cast<T>(1) << (DIGITS/2)) + 1);
+      }
+   }
+public:
+   explicit scaled_pairs(const Generator& base = Generator()) : base(base)
+   {
+      reset();
+   }
+   void reset()
+   {
+      base.reset();
+      factorIndex = 0;
+   }
+   bool next(T* pA, T* pB)
+   {
+      for (; factorIndex < NUM_FACTORS; ++factorIndex, base.reset()) {
+         T k = get_factor(factorIndex);
+         T limit = static_cast<T>(std::numeric_limits<T>::max() / k);
+         T a, b;
+         while (base.next(&a, &b)) {
+            if (a > limit || b > limit)
+               continue;
+            *pA = static_cast<T>(a * k);
+            *pB = static_cast<T>(b * k);
+            return true;
+         }
+      }
+      return false;
+   }
+};
+
+
+// 'count' pseudo-random pairs drawn from xoshiro256** with the given seed.
+// If randomLength is true, each value gets a uniformly chosen bit length
+// (which makes quotients of every size likely); otherwise values are uniform.
+template <class T>
+class random_pairs {
+   static_assert(std::numeric_limits<T>::is_integer, "");
+   static constexpr int DIGITS = std::numeric_limits<T>::digits;
+   static_assert(DIGITS <= 64, "");
+   uint64_t seed, count, index;
+   bool randomLength;
+   xoshiro256ss rng;
+
+   T next_value()
+   {
+      if (randomLength)
+         return static_cast<T>(rng.next_random_length(DIGITS));
+      return static_cast<T>(rng.next() >> (64 - DIGITS));
+   }
+public:
+   random_pairs(uint64_t count, uint64_t seed, bool randomLength = false)
+      : seed(seed), count(count), index(0), randomLength(randomLength),
+        rng(seed)
+   {
+   }
+   void reset()
+   {
+      index = 0;
+      rng = xoshiro256ss(seed);
+   }
+   bool next(T* pA, T* pB)
+   {
+      if (index == count)
+         return false;
+      ++index;
+      *pA = next_value();
+      *pB = next_value();
+      return true;
+   }
+};
+
+
+// All of the deterministic generators, one after another.
+template <class T>
+class adversarial_pairs {
+   fibonacci_pairs<T> fibonacci;
+   large_quotient_pairs<T> largeQuotient;
+   large_gcd_pairs<T> largeGcd;
+   near_power_of_two_pairs<T> nearPowerOfTwo;
+   scaled_pairs<fibonacci_pairs<T>, T> scaledFibonacci;
+   int stage;
+public:
+   adversarial_pairs() { reset(); }
+   void reset()
+   {
+      fibonacci.reset();
+      largeQuotient.reset();
+      largeGcd.reset();
+      nearPowerOfTwo.reset();
+      scaledFibonacci.reset();
+      stage = 0;
+   }
+   bool next(T* pA, T* pB)
+   {
+      for (;; ++stage) {
+         switch (stage) {
+            case 0: if (fibonacci.next(pA, pB)) return true; break;
+            case 1: if (largeQuotient.next(pA, pB)) return true; break;
+            case 2: if (largeGcd.next(pA, pB)) return true; break;
+            case 3: if (nearPowerOfTwo.next(pA, pB)) return true; break;
+            case 4: if (scaledFibonacci.next(pA, pB)) return true; break;
+            default: return false;
+         }
+      }
+   }
+};
+
+#endif
@@ -0,0 +1,109 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// A batched version of unsigned_extended_euclidean() that advances LANES
+// independent problems in lockstep within one thread.  A single call of
+// unsigned_extended_euclidean() is a serial dependency chain through
+// q = a0/a1, so the core mostly waits on the divider; the loop iterations of
+// different lanes don't depend on each other, so an out-of-order core can
+// overlap their divisions and multiplies.  When a lane's problem finishes,
+// its results are written and the lane is refilled with the next problem of
+// the batch, keeping all lanes busy until the batch runs out.
+//
+// For every i < n, the results pGcd[i], pX[i], pY[i] are identical to those
+// of unsigned_extended_euclidean(a[i], b[i], ...).
+//
+// interleaved_extended_euclidean_strided() is the same engine for inputs and
+// results that are spaced apart in memory, such as fields of packed records:
+// it reads a[i*inStride] and b[i*inStride], and writes pGcd[i*outStride],
+// pX[i*outStride] and pY[i*outStride].
+
+#ifndef INTERLEAVED_EXTENDED_EUCLIDEAN
+#define INTERLEAVED_EXTENDED_EUCLIDEAN 1
+
+#include <limits>
+#include <type_traits>
+#include <cstddef>
+
+
+template <int LANES, class S, class U>
+void interleaved_extended_euclidean_strided(const U* a, const U* b,
+                                            std::size_t inStride, std::size_t n,
+                                            U* pGcd, S* pX, S* pY,
+                                            std::size_t outStride)
+{
+   static_assert(LANES >= 1, "");
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+
+   // the loop state of unsigned_extended_euclidean(), one copy per lane
+   S x1[LANES], y1[LANES], x0[LANES], y0[LANES];
+   U a1[LANES], a2[LANES], q[LANES];
+   std::size_t index[LANES];
+   bool live[LANES];
+
+   std::size_t next = 0;
+   // Starts the next unfinished problem of the batch in the given lane, or
+   // marks the lane dead if none remain.  Problems with b == 0 need no loop
+   // iterations, and are finished here directly.
+   auto refill = [&](int lane) {
+      while (next < n && b[next*inStride] == 0) {
+         pGcd[next*outStride] = a[next*inStride];
+         pX[next*outStride] = 1;
+         pY[next*outStride] = 0;
+         ++next;
+      }
+      if (next == n) {
+         live[lane] = false;
+         return;
+      }
+      x1[lane] = 1; y1[lane] = 0; a1[lane] = a[next*inStride];
+      x0[lane] = 0; y0[lane] = 1;
+      a2[lane] = b[next*inStride]; q[lane] = 0;
+      index[lane] = next++;
+      live[lane] = true;
+   };
+   int numLive = 0;
+   for (int lane = 0; lane < LANES; ++lane) {
+      refill(lane);
+      numLive += live[lane];
+   }
+
+   while (numLive > 0) {
+      for (int lane = 0; lane < LANES; ++lane) {
+         if (!live[lane])
+            continue;
+         S x2 = x0[lane] - static_cast<S>(q[lane])*x1[lane];
+         S y2 = y0[lane] - static_cast<S>(q[lane])*y1[lane];
+         x0[lane]=x1[lane]; y0[lane]=y1[lane];
+         U a0=a1[lane];
+         x1[lane]=x2; y1[lane]=y2; a1[lane]=a2[lane];
+
+         q[lane] = a0/a1[lane];
+         a2[lane] = a0 - q[lane]*a1[lane];
+
+         if (a2[lane] == 0) {
+            std::size_t i = index[lane] * outStride;
+            pX[i] = x1[lane];
+            pY[i] = y1[lane];
+            pGcd[i] = a1[lane];
+            refill(lane);
+            numLive -= !live[lane];
+         }
+      }
+   }
+}
+
+
+template <int LANES, class S, class U>
+void interleaved_extended_euclidean(const U* a, const U* b, std::size_t n,
+                                    U* pGcd, S* pX, S* pY)
+{
+   interleaved_extended_euclidean_strided<LANES, S, U>(a, b, 1, n,
+                                                       pGcd, pX, pY, 1);
+}
+
+#endif
@@ -0,0 +1,202 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// The Jacobi symbol (a|n), for odd n, and the Kronecker symbol, which extends
+// it to every n.  Each returns -1, 0 or 1.
+//
+//    jacobi_symbol(a, n)         The remainder sequence of the loop of
+//         unsigned_extended_euclidean() on (a, n), unchanged: no factors of
+//         2 are removed from the remainders, so the sign is tracked with a
+//         little state per step (below).
+//    binary_jacobi_symbol(a, n)  The binary algorithm: shifts, subtractions
+//         and swaps, tracking the sign from the low 3 bits of the operands.
+//    kronecker_symbol(a, n)      Any n (and for signed types, any a): the
+//         factors 2 and -1 of n by their rules, then jacobi_symbol().
+//    extended_euclidean_jacobi(a, n, &gcd, &inverse, &symbol)
+//         One run of the quotient loop gives gcd(a, n), the inverse of a
+//         modulo n (in [0, n), or 0 if there is none) and (a|n), for odd n.
+//         The inverse is the Euclidean coefficient x, which final_bounds.h
+//         shows fits S.
+//
+// Tracking the sign along a plain remainder sequence a0, a1, a2 == a0 mod a1:
+// since n is odd, gcd(a, n) is odd, so no two consecutive remainders are
+// even.  The loop keeps (a|n) == (-1)^flip * J, where J is (a0|a1) with a1
+// odd, or (a1|a0) with a0 odd.  Then a step gives
+//
+//    (a0|a1) == (a2|a1)                     J becomes (a2|a1): no sign change
+//    (a1|a0), a1 odd:  == e(a1,a0)*(a0|a1)  == e(a1,a0)*(a2|a1)
+//    (a1|a0), a1 == 2^k*o, o odd:
+//       == (2|a0)^k * e(o,a0) * (a0|o)      and (a0|o) == (a2|o), as o | a1
+//       == (2|a0)^k * e(o,a0) * e(a2,o) * (2|a2)^k * (a1|a2)
+//
+// with e(u,v) == -1 just if u == v == 3 (mod 4) (reciprocity), and
+// (2|v) == -1 just if v == 3 or 5 (mod 8).  In the last case a2 is odd, as
+// a0 is odd and a1 even.  The loop ends with a1 == 0 and J == (0|gcd), which
+// is 1 if gcd == 1 and 0 otherwise.
+
+#ifndef JACOBI_SYMBOL
+#define JACOBI_SYMBOL 1
+
+#include "signed_input_extended_euclidean.h"
+#include <bit>
+#include <limits>
+#include <type_traits>
+#include <assert.h>
+
+
+// 1 if (2|v) == -1, i.e. v == 3 or 5 (mod 8), else 0; v odd
+template <class U>
+unsigned jacobi_two_flip(const U v)
+{
+   return static_cast<unsigned>(((v >> 1) ^ (v >> 2)) & 1u);
+}
+
+// 1 if reciprocity for odd u and v flips the sign (u == v == 3 mod 4), else 0
+template <class U>
+unsigned jacobi_reciprocity_flip(const U u, const U v)
+{
+   return static_cast<unsigned>((u & v) >> 1 & 1u);
+}
+
+// One step a2 == a0 mod a1 (a1 != 0) of the remainder sequence, as above:
+// *pOddA1 tells whether J is (a0|a1) rather than (a1|a0), and becomes the
+// same for (a1, a2).
+template <class U>
+void jacobi_remainder_step(const U a0, const U a1, const U a2, bool* pOddA1,
+                           unsigned* pFlip)
+{
+   if (*pOddA1) {
+      *pOddA1 = false;
+   } else if ((a1 & 1u) != 0) {
+      *pFlip ^= jacobi_reciprocity_flip(a1, a0);
+   } else {
+      int k = std::countr_zero(a1);
+      U o = static_cast<U>(a1 >> k);
+      *pFlip ^= static_cast<unsigned>(k & 1) & (jacobi_two_flip(a0) ^ jacobi_two_flip(a2));
+      *pFlip ^= jacobi_reciprocity_flip(o, a0) ^ jacobi_reciprocity_flip(a2, o);
+      *pOddA1 = true;
+   }
+}
+
+
+template <class U>
+int jacobi_symbol(const U a, const U n)
+{
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   assert((n & 1u) == 1u);   // precondition: n is odd
+   bool oddA1 = true;
+   unsigned flip = 0;
+   U a1=a;
+   U a2=n, q=0;
+
+   while (a2 != 0) {
+      U a0=a1;
+      a1=a2;
+
+      q = a0/a1;
+      a2 = a0 - q*a1;
+      jacobi_remainder_step(a0, a1, a2, &oddA1, &flip);
+   }
+   assert(!oddA1);
+   return (a1 != 1) ? 0 : 1 - 2*static_cast<int>(flip);
+}
+
+
+template <class U>
+int binary_jacobi_symbol(U a, U n)
+{
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   assert((n & 1u) == 1u);   // precondition: n is odd
+   unsigned flip = 0;
+   // invariants: n is odd, and (a|n) of the inputs is (-1)^flip * (a|n)
+   while (a != 0) {
+      int k = std::countr_zero(a);
+      a = static_cast<U>(a >> k);
+      flip ^= static_cast<unsigned>(k & 1) & jacobi_two_flip(n);
+      if (a < n) {
+         U t = a;
+         a = n;
+         n = t;
+         flip ^= jacobi_reciprocity_flip(a, n);
+      }
+      a = static_cast<U>(a - n);   // both odd, so the difference is even
+   }
+   return (n != 1) ? 0 : 1 - 2*static_cast<int>(flip);
+}
+
+
+// (a|n) for any n: (a|0) is 1 if |a| == 1, else 0; (a|2) is 0 for even a, 1
+// for a == 1 or 7 (mod 8), and -1 for a == 3 or 5 (mod 8); and for signed T,
+// (a|-1) is -1 if a < 0, else 1.  T is an unsigned or signed integer type.
+template <class T>
+int kronecker_symbol(const T a, const T n)
+{
+   static_assert(std::numeric_limits<T>::is_integer, "");
+   using U = typename std::make_unsigned<T>::type;
+   U absA = static_cast<U>(a), absN = static_cast<U>(n);
+   unsigned flip = 0;
+   if constexpr (std::numeric_limits<T>::is_signed) {
+      absA = unsigned_magnitude(a);
+      absN = unsigned_magnitude(n);
+      flip = static_cast<unsigned>(n < 0 && a < 0);
+   }
+   if (absN == 0)
+      return (absA == 1) ? 1 : 0;
+   int k = std::countr_zero(absN);
+   if (k > 0 && (a & 1) == 0)
+      return 0;
+   // a's low bits are those of a modulo 8, for either sign
+   flip ^= static_cast<unsigned>(k & 1) & jacobi_two_flip(static_cast<U>(a));
+   U oddN = static_cast<U>(absN >> k);
+   if constexpr (std::numeric_limits<T>::is_signed) {
+      // (a|m) == (-1|m)*(|a| |m) for a < 0 and odd m, with (-1|m) == -1 just
+      // if m == 3 (mod 4)
+      flip ^= static_cast<unsigned>(a < 0) & static_cast<unsigned>(oddN >> 1 & 1u);
+   }
+   int j = jacobi_symbol(static_cast<U>(absA % oddN), oddN);
+   return (flip != 0) ? -j : j;
+}
+
+
+// unsigned_extended_euclidean(a, n) and jacobi_symbol(a, n) in one loop, for
+// odd n; the inverse is in [0, n), or 0 if gcd != 1 (and for n == 1).
+template <class S, class U>
+void extended_euclidean_jacobi(const U a, const U n, U* pGcd, U* pInverse, int* pSymbol)
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+   assert((n & 1u) == 1u);   // precondition: n is odd
+   bool oddA1 = true;
+   unsigned flip = 0;
+   S x1=1;
+   U a1=a;
+   S x0=0;
+   U a2=n, q=0;
+
+   while (a2 != 0) {
+      S x2 = x0 - static_cast<S>(q)*x1;
+      x0=x1;
+      U a0=a1;
+      x1=x2; a1=a2;
+
+      q = a0/a1;
+      a2 = a0 - q*a1;
+      jacobi_remainder_step(a0, a1, a2, &oddA1, &flip);
+   }
+   assert(!oddA1);
+   // x1 is the Euclidean x, with |x1| <= max(1, n/2); for gcd == 1 and
+   // n > 1 it's in (-n, n), so adding n to a negative one puts it in [0, n)
+   U inverse = static_cast<U>(x1);
+   if (x1 < 0)
+      inverse = static_cast<U>(inverse + n);
+   *pInverse = (a1 == 1 && n != 1) ? inverse : U(0);
+   *pSymbol = (a1 != 1) ? 0 : 1 - 2*static_cast<int>(flip);
+   *pGcd = a1;
+}
+
+#endif
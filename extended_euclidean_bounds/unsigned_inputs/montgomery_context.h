@@ -0,0 +1,97 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Montgomery arithmetic modulo odd m, with R == 2^N for N bit U.  A
+// montgomery_context<U> holds m, m' == -m^-1 mod R and R^2 mod m, so setting
+// one up for a new modulus is cheap:
+//
+//    m'          inverse_mod_word() of extended_euclidean_variants.h, negated:
+//                Newton-Hensel iteration, a few multiplies and no division
+//                (an extended Euclidean run on (m, 2^N) takes about N steps,
+//                each with a division).
+//    R^2 mod m   one division for R mod m == (R - m) mod m, one modular
+//                doubling for 2R mod m, which is the Montgomery form of 2,
+//                and log2(N) Montgomery squarings: squaring the form of
+//                2^(2^k) gives that of 2^(2^(k+1)), and the form of 2^N is
+//                R^2 mod m.
+//
+// multiply(a, b) is a*b/R mod m by Montgomery's REDC, for a and b in [0, m),
+// and is in [0, m); to_montgomery(a) is a*R mod m, and from_montgomery()
+// inverts it.  m may be any odd value, including 1 and values above R/2 (the
+// REDC sum can then exceed N bits, and its carry is kept).  U is an unsigned
+// type of 8, 16, 32, 64 or 128 bits; the double width products are those of
+// wide_multiply.h.
+
+#ifndef MONTGOMERY_CONTEXT
+#define MONTGOMERY_CONTEXT 1
+
+#include "extended_euclidean_variants.h"
+#include "wide_multiply.h"
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <assert.h>
+
+
+template <class U>
+class montgomery_context {
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static constexpr int N = std::numeric_limits<U>::digits;
+   static_assert(N == 8 || N == 16 || N == 32 || N == 64 || N == 128, "");
+   using P = typename std::common_type<U, unsigned int>::type;   // no int promotion
+
+   U m;
+   U mPrime;     // -m^-1 mod R
+   U rSquared;   // R^2 mod m
+
+   // t - m if t >= m or if the sum that gave t carried out of N bits
+   U subtract_if_not_below(const U t, const U carry) const
+   {
+      U mask = static_cast<U>(0u - static_cast<P>(carry | static_cast<U>(t >= m)));
+      return static_cast<U>(static_cast<P>(t) - static_cast<P>(m & mask));
+   }
+   // (high*R + low)/R mod m, for high*R + low < m*R, by REDC
+   U reduce(const U high, const U low) const
+   {
+      U q = static_cast<U>(static_cast<P>(low) * mPrime);
+      U qmLow;
+      U qmHigh = wide_multiply(q, m, &qmLow);
+      // low + qmLow == 0 mod R, so it carries exactly when low != 0; then
+      // the quotient high + qmHigh + carry is below 2m, but may exceed N bits
+      U sum = static_cast<U>(static_cast<P>(high) + qmHigh);
+      U carry = static_cast<U>(sum < high);
+      U t = static_cast<U>(static_cast<P>(sum) + static_cast<U>(low != 0));
+      carry |= static_cast<U>(t < sum);
+      return subtract_if_not_below(t, carry);
+   }
+
+public:
+   explicit montgomery_context(const U modulus) : m(modulus)
+   {
+      assert((m & 1u) == 1u);
+      mPrime = static_cast<U>(0u - static_cast<P>(inverse_mod_word(m)));
+      U r = static_cast<U>(static_cast<U>(0u - static_cast<P>(m)) % m);   // R mod m
+      U twice = static_cast<U>(static_cast<P>(r) + r);
+      U x = subtract_if_not_below(twice, static_cast<U>(twice < r));   // 2R mod m
+      for (int bits = 1; bits < N; bits *= 2)
+         x = multiply(x, x);
+      rSquared = x;
+   }
+
+   U modulus() const { return m; }
+   U negated_inverse() const { return mPrime; }
+   U r_squared() const { return rSquared; }
+
+   U multiply(const U a, const U b) const
+   {
+      assert(a < m && b < m);
+      U low;
+      U high = wide_multiply(a, b, &low);
+      return reduce(high, low);
+   }
+   U to_montgomery(const U a) const { return multiply(a, rSquared); }
+   U from_montgomery(const U a) const { return reduce(0, a); }
+};
+
+#endif
@@ -0,0 +1,280 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Modular inversion and the extended gcd for odd moduli by Pornin's optimized
+// binary GCD ("Optimized Binary GCD for Modular Inversion", 2020).  For wide
+// values each step of the plain loop is a multiword division; the binary GCD
+// needs only subtractions and shifts, and this version does most of them on
+// single words.
+//
+// The binary GCD on (a, b) = (y, m), with m odd, repeats: if a is odd, swap
+// a and b if a < b, then a -= b; then a /= 2.  It keeps b odd, and ends with
+// a == 0 and b == gcd(y, m).  Its first 31 steps depend only on the low 31
+// bits of a and b and, for the comparisons, on their top bits, so they're run
+// on 64-bit approximations: the low 31 bits and the top 33 bits of the
+// common length n = max(len(a), len(b), 64).  The steps accumulate in a 2x2
+// matrix (scaled by 2^31), which is then applied to the full a and b; since
+// the comparisons were approximate, a or b can come out negative, and is
+// negated along with its matrix row.  The same matrix is applied to u and v,
+// with a == u*y and b == v*y (mod m), dividing by 2^31 modulo m as in the
+// safegcd engine.  Once n == 64 the approximations are exact.  Pornin shows
+// that 2*N - 1 steps suffice for N bit inputs, so the engine runs
+// ceil((2*N - 1)/31) batches: 17 at 256 bits.
+//
+// The inner steps and the matrix applications are branch-free, and the
+// number of batches is fixed.  optimized_binary_extended_euclidean(a, b)
+// requires b odd, and returns results identical to those of
+// unsigned_extended_euclidean(a, b), by extended_euclidean_from_modular() of
+// safegcd_extended_euclidean.h; optimized_binary_inverse(a, m) is the inverse
+// of a modulo odd m, in [0, m), or 0 if there is none.  U is as for the
+// safegcd engine, and the full values are held in 64-bit limbs.  Like the
+// safegcd engine it needs __int128, and without it the header defines nothing.
+
+#ifndef OPTIMIZED_BINARY_GCD
+#define OPTIMIZED_BINARY_GCD 1
+
+#include "extended_euclidean_variants.h"
+#include "safegcd_extended_euclidean.h"
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <assert.h>
+
+#ifdef __SIZEOF_INT128__
+
+constexpr int BINARY_GCD_BATCH = 31;
+constexpr uint64_t BINARY_GCD_LOW_MASK = (uint64_t(1) << BINARY_GCD_BATCH) - 1;
+
+// 2^31 times the matrix of 31 steps: [a', b'] == [f0 g0; f1 g1] * [a, b] / 2^31.
+// Every row's absolute values sum to at most 2^31.
+struct binary_gcd_matrix {
+   int64_t f0, g0, f1, g1;
+};
+
+template <int WORDS>
+struct binary_gcd_limbs {
+   uint64_t w[WORDS];
+};
+
+
+template <int WORDS, class U>
+binary_gcd_limbs<WORDS> to_binary_gcd_limbs(const U& a)
+{
+   binary_gcd_limbs<WORDS> r;
+   for (int i = 0; i < WORDS; ++i)
+      r.w[i] = (64 * i < std::numeric_limits<U>::digits) ? static_cast<uint64_t>(a >> (64 * i)) : 0;
+   return r;
+}
+
+template <class U, int WORDS>
+U from_binary_gcd_limbs(const binary_gcd_limbs<WORDS>& a)
+{
+   U r = 0;
+   for (int i = 0; i < WORDS; ++i) {
+      if (64 * i < std::numeric_limits<U>::digits)
+         r = static_cast<U>(r | (static_cast<U>(a.w[i]) << (64 * i)));
+   }
+   return r;
+}
+
+
+// The 64-bit approximations of a and b: their low 31 bits, below their top
+// 33 bits at the common length max(len(a), len(b), 64).  The word accesses
+// and shifts don't depend on the length.
+template <int WORDS>
+void binary_gcd_approximations(const binary_gcd_limbs<WORDS>& a,
+                               const binary_gcd_limbs<WORDS>& b,
+                               uint64_t* pA, uint64_t* pB)
+{
+   int len = 64;
+   for (int i = 1; i < WORDS; ++i) {
+      uint64_t x = a.w[i] | b.w[i];
+      int nonzero = -static_cast<int>(x != 0);
+      len = (len & ~nonzero) | ((64 * i + 64 - std::countl_zero(x)) & nonzero);
+   }
+   // the top 33 bits start at bit len - 33, in word k at bit s
+   int k = (len - 33) / 64, s = (len - 33) % 64;
+   uint64_t aLo = 0, aHi = 0, bLo = 0, bHi = 0;
+   for (int i = 0; i < WORDS; ++i) {
+      uint64_t lo = uint64_t(0) - static_cast<uint64_t>(i == k);
+      uint64_t hi = uint64_t(0) - static_cast<uint64_t>(i == k + 1);
+      aLo |= a.w[i] & lo;
+      aHi |= a.w[i] & hi;
+      bLo |= b.w[i] & lo;
+      bHi |= b.w[i] & hi;
+   }
+   // (hi << 1) << (63 - s) is hi << (64 - s), and 0 for s == 0
+   uint64_t aTop = (aLo >> s) | ((aHi << 1) << (63 - s));
+   uint64_t bTop = (bLo >> s) | ((bHi << 1) << (63 - s));
+   *pA = (aTop << BINARY_GCD_BATCH) | (a.w[0] & BINARY_GCD_LOW_MASK);
+   *pB = (bTop << BINARY_GCD_BATCH) | (b.w[0] & BINARY_GCD_LOW_MASK);
+}
+
+// 31 steps on the approximations
+inline void binary_gcd_steps_31(uint64_t a, uint64_t b, binary_gcd_matrix* pT)
+{
+   uint64_t f0 = 1, g0 = 0, f1 = 0, g1 = 1;   // wraps; the results fit int64_t
+   for (int i = 0; i < BINARY_GCD_BATCH; ++i) {
+      assert((b & 1) == 1);
+      uint64_t odd = uint64_t(0) - (a & 1);
+      uint64_t swap = odd & (uint64_t(0) - static_cast<uint64_t>(a < b));
+      uint64_t t = (a ^ b) & swap;
+      a ^= t;
+      b ^= t;
+      t = (f0 ^ f1) & swap;
+      f0 ^= t;
+      f1 ^= t;
+      t = (g0 ^ g1) & swap;
+      g0 ^= t;
+      g1 ^= t;
+      a -= b & odd;
+      f0 -= f1 & odd;
+      g0 -= g1 & odd;
+      a >>= 1;
+      f1 <<= 1;
+      g1 <<= 1;
+   }
+   pT->f0 = static_cast<int64_t>(f0);
+   pT->g0 = static_cast<int64_t>(g0);
+   pT->f1 = static_cast<int64_t>(f1);
+   pT->g1 = static_cast<int64_t>(g1);
+}
+
+// (f*a + g*b) / 2^31, which is exact, as a magnitude and a sign mask
+template <int WORDS>
+uint64_t binary_gcd_combine(const binary_gcd_limbs<WORDS>& a,
+                            const binary_gcd_limbs<WORDS>& b,
+                            int64_t f, int64_t g, binary_gcd_limbs<WORDS>* pR)
+{
+   uint64_t r[WORDS + 1];
+   __int128 c = 0;
+   for (int i = 0; i < WORDS; ++i) {
+      c += static_cast<__int128>(a.w[i]) * f + static_cast<__int128>(b.w[i]) * g;
+      r[i] = static_cast<uint64_t>(c);
+      c >>= 64;
+   }
+   r[WORDS] = static_cast<uint64_t>(c);
+   assert((r[0] & BINARY_GCD_LOW_MASK) == 0);
+   // the magnitude, by a masked two's complement negation
+   uint64_t sign = static_cast<uint64_t>(static_cast<int64_t>(r[WORDS]) >> 63);
+   uint64_t carry = sign & 1;
+   for (int i = 0; i <= WORDS; ++i) {
+      unsigned __int128 t = static_cast<unsigned __int128>(r[i] ^ sign) + carry;
+      r[i] = static_cast<uint64_t>(t);
+      carry = static_cast<uint64_t>(t >> 64);
+   }
+   for (int i = 0; i < WORDS; ++i)
+      pR->w[i] = (r[i] >> BINARY_GCD_BATCH) | (r[i + 1] << (64 - BINARY_GCD_BATCH));
+   assert((r[WORDS] >> BINARY_GCD_BATCH) == 0);
+   return sign;
+}
+
+// (f*u + g*v) / 2^31 modulo m, for u, v in [0, m), negated if sign is all
+// ones; mInv31 is the inverse of m modulo 2^31.  The result is in [0, m).
+template <int WORDS>
+void binary_gcd_combine_mod(const binary_gcd_limbs<WORDS>& u,
+                            const binary_gcd_limbs<WORDS>& v,
+                            int64_t f, int64_t g, uint64_t sign,
+                            const binary_gcd_limbs<WORDS>& m, uint64_t mInv31,
+                            binary_gcd_limbs<WORDS>* pR)
+{
+   // negating f and g negates the result
+   f = static_cast<int64_t>((static_cast<uint64_t>(f) ^ sign) - sign);
+   g = static_cast<int64_t>((static_cast<uint64_t>(g) ^ sign) - sign);
+   uint64_t low = u.w[0] * static_cast<uint64_t>(f) + v.w[0] * static_cast<uint64_t>(g);
+   uint64_t k = ((uint64_t(0) - low) * mInv31) & BINARY_GCD_LOW_MASK;
+   // f*u + g*v + k*m is in (-2^31*m, 2^32*m), and divisible by 2^31
+   uint64_t r[WORDS + 1];
+   __int128 c = 0;
+   for (int i = 0; i < WORDS; ++i) {
+      c += static_cast<__int128>(u.w[i]) * f + static_cast<__int128>(v.w[i]) * g +
+           static_cast<__int128>(static_cast<unsigned __int128>(m.w[i]) * k);
+      r[i] = static_cast<uint64_t>(c);
+      c >>= 64;
+   }
+   r[WORDS] = static_cast<uint64_t>(c);
+   assert((r[0] & BINARY_GCD_LOW_MASK) == 0);
+   uint64_t q[WORDS + 1];
+   for (int i = 0; i < WORDS; ++i)
+      q[i] = (r[i] >> BINARY_GCD_BATCH) | (r[i + 1] << (64 - BINARY_GCD_BATCH));
+   q[WORDS] = static_cast<uint64_t>(static_cast<int64_t>(r[WORDS]) >> BINARY_GCD_BATCH);
+   // now q is in (-m, 2m): add m if it's negative, else subtract m if that
+   // leaves it nonnegative
+   uint64_t negative = static_cast<uint64_t>(static_cast<int64_t>(q[WORDS]) >> 63);
+   uint64_t carry = 0;
+   for (int i = 0; i <= WORDS; ++i) {
+      uint64_t mi = (i < WORDS) ? m.w[i] : 0;
+      unsigned __int128 t = static_cast<unsigned __int128>(q[i]) + (mi & negative) + carry;
+      q[i] = static_cast<uint64_t>(t);
+      carry = static_cast<uint64_t>(t >> 64);
+   }
+   uint64_t d[WORDS + 1];
+   uint64_t borrow = 0;
+   for (int i = 0; i <= WORDS; ++i) {
+      uint64_t mi = (i < WORDS) ? m.w[i] : 0;
+      unsigned __int128 t = static_cast<unsigned __int128>(q[i]) - mi - borrow;
+      d[i] = static_cast<uint64_t>(t);
+      borrow = static_cast<uint64_t>(t >> 64) & 1;
+   }
+   uint64_t keep = uint64_t(0) - borrow;   // all ones if q < m
+   for (int i = 0; i < WORDS; ++i)
+      pR->w[i] = (q[i] & keep) | (d[i] & ~keep);
+}
+
+
+// Runs the batches on a = y, b = m (odd), and returns gcd(y, m) and d in
+// [0, m) with d*y == gcd (mod m).
+template <class U>
+void optimized_binary_gcd(const U y, const U m, U* pGcd, U* pD)
+{
+   constexpr int BITS = std::numeric_limits<U>::digits;
+   constexpr int WORDS = (BITS + 63) / 64;
+   constexpr int BATCHES = (2 * BITS - 1 + BINARY_GCD_BATCH - 1) / BINARY_GCD_BATCH;
+   assert((static_cast<uint64_t>(m) & 1) == 1);
+   binary_gcd_limbs<WORDS> a = to_binary_gcd_limbs<WORDS>(y);
+   binary_gcd_limbs<WORDS> b = to_binary_gcd_limbs<WORDS>(m);
+   const binary_gcd_limbs<WORDS> mm = b;
+   binary_gcd_limbs<WORDS> u = {}, v = {};
+   u.w[0] = static_cast<uint64_t>(m != 1);   // 1 modulo m
+   const uint64_t mInv31 = inverse_mod_word(static_cast<uint64_t>(m)) & BINARY_GCD_LOW_MASK;
+   for (int i = 0; i < BATCHES; ++i) {
+      uint64_t aApprox, bApprox;
+      binary_gcd_approximations(a, b, &aApprox, &bApprox);
+      binary_gcd_matrix T;
+      binary_gcd_steps_31(aApprox, bApprox, &T);
+      binary_gcd_limbs<WORDS> na, nb, nu, nv;
+      uint64_t signA = binary_gcd_combine(a, b, T.f0, T.g0, &na);
+      uint64_t signB = binary_gcd_combine(a, b, T.f1, T.g1, &nb);
+      binary_gcd_combine_mod(u, v, T.f0, T.g0, signA, mm, mInv31, &nu);
+      binary_gcd_combine_mod(u, v, T.f1, T.g1, signB, mm, mInv31, &nv);
+      a = na; b = nb;
+      u = nu; v = nv;
+   }
+   assert(from_binary_gcd_limbs<U>(a) == 0);
+   *pGcd = from_binary_gcd_limbs<U>(b);
+   *pD = from_binary_gcd_limbs<U>(v);
+}
+
+
+template <class S, class U>
+void optimized_binary_extended_euclidean(const U a, const U b, U* pGcd, S* pX, S* pY)
+{
+   assert((static_cast<uint64_t>(b) & 1) == 1);   // precondition: b is odd
+   U gcd, d;
+   optimized_binary_gcd(a, b, &gcd, &d);
+   extended_euclidean_from_modular(a, b, gcd, d, pGcd, pX, pY);
+}
+
+// The inverse of a modulo odd m, in [0, m), or 0 if gcd(a, m) != 1.
+template <class U>
+U optimized_binary_inverse(const U a, const U m)
+{
+   U gcd, d;
+   optimized_binary_gcd(a, m, &gcd, &d);
+   return static_cast<U>(d & static_cast<U>(U(0) - static_cast<U>(gcd == 1)));
+}
+
+#endif
+
+#endif
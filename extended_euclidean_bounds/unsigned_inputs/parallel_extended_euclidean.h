@@ -0,0 +1,64 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Solves a large batch of extended gcd problems on a persistent
+// work_stealing_pool.  For every i, g[i], x[i], y[i] are the results of
+// unsigned_extended_euclidean(a[i], b[i], ...).
+//
+// The batch is split into chunks of CHUNK elements, where CHUNK is a multiple
+// of 64 elements and so a whole number of 64 byte cache lines of every result
+// array.  A chunk is solved into thread-local buffers by
+// interleaved_extended_euclidean(), and then copied to the result spans in
+// one pass per array.  Consequently two threads can only ever write the same
+// cache line at a chunk boundary (if a result array isn't cache line
+// aligned), and then only once per chunk rather than once per element.
+
+#ifndef PARALLEL_EXTENDED_EUCLIDEAN
+#define PARALLEL_EXTENDED_EUCLIDEAN 1
+
+#include "interleaved_extended_euclidean.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+
+template <class S, class U>
+void parallel_extended_euclidean(std::span<const U> a, std::span<const U> b,
+                                 std::span<U> g, std::span<S> x, std::span<S> y,
+                                 work_stealing_pool& pool =
+                                       work_stealing_pool::default_instance())
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+   assert(b.size() == a.size() && g.size() == a.size() &&
+          x.size() == a.size() && y.size() == a.size());   // precondition
+
+   constexpr std::size_t CHUNK = 1024;
+   constexpr int LANES = 4;
+   static_assert(CHUNK % 64 == 0, "");
+   const std::size_t n = a.size();
+   const std::size_t numChunks = (n + CHUNK - 1) / CHUNK;
+
+   pool.parallel_for(numChunks, [&](std::size_t chunk) {
+         alignas(64) U localG[CHUNK];
+         alignas(64) S localX[CHUNK];
+         alignas(64) S localY[CHUNK];
+         std::size_t begin = chunk * CHUNK;
+         std::size_t count = std::min(CHUNK, n - begin);
+         interleaved_extended_euclidean<LANES, S, U>(a.data() + begin,
+                     b.data() + begin, count, localG, localX, localY);
+         std::memcpy(g.data() + begin, localG, count * sizeof(U));
+         std::memcpy(x.data() + begin, localX, count * sizeof(S));
+         std::memcpy(y.data() + begin, localY, count * sizeof(S));
+      });
+}
+
+#endif
@@ -0,0 +1,316 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// A constant-time extended gcd and modular inverse for odd moduli, by the
+// divsteps algorithm of Bernstein and Yang ("Fast constant-time gcd
+// computation and modular inversion", 2019), organized like the safegcd
+// implementation of libsecp256k1.
+//
+// A divstep maps (delta, f, g), with f odd, to
+//    (1 - delta, g, (g - f)/2)       if delta > 0 and g is odd,
+//    (1 + delta, f, (g + (g&1)*f)/2) otherwise.
+// Starting from (1, b, a), a fixed number of divsteps that depends only on
+// the width (187 at 64 bits, 372 at 128, 741 at 256, by the paper's bound
+// floor((49*N + 57)/17) for N >= 46 bits) always reaches g == 0 with
+// f == +-gcd(a,b).  Each run of 62 divsteps depends only on the low 64 bits
+// of f and g, so it's computed on single words as a 2x2 transition matrix
+// (scaled by 2^62), which is then applied to the full f and g, and to the
+// coefficients d and e with d*a == f and e*a == g (mod b).  The full values
+// are held in signed 62-bit limbs, so that a limb times a matrix entry fits
+// in 128 bits.  The matrix is applied to d and e modulo b: adding the right
+// multiple of b, found with the inverse of b modulo 2^62, makes the product
+// divisible by 2^62.
+//
+// Every divstep, matrix application and the final normalization is
+// branch-free, and so are the fixed_uint comparisons and multiplies used at
+// 256 bits, so for coprime inputs (every modular inversion) the run time
+// doesn't depend on the inputs.  Only a gcd other than 1 takes a further,
+// variable time, reduction (a division).
+//
+// safegcd_extended_euclidean(a, b) requires b odd, and returns results
+// identical to those of unsigned_extended_euclidean(a, b), which
+// extended_euclidean_from_modular() derives from d*a == gcd (mod b): x is d
+// reduced modulo b/gcd to the range (-b/(2*gcd), b/(2*gcd)), which is where
+// the Euclidean coefficient lies (b/gcd is odd, so this is unique), and
+// y == (gcd - a*x)/b by an exact division, as a multiply by the inverse of b
+// modulo 2^N.  safegcd_inverse(a, m) is the inverse of a modulo
+// odd m, in [0, m), or 0 if there is none.
+//
+// U is a native unsigned type of up to 64 bits, unsigned __int128, or a
+// fixed_uint of fixed_width_integer.h; S is its signed counterpart.
+// Needs __int128; without it the header defines nothing.
+
+#ifndef SAFEGCD_EXTENDED_EUCLIDEAN
+#define SAFEGCD_EXTENDED_EUCLIDEAN 1
+
+#include "extended_euclidean_variants.h"
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <assert.h>
+
+#ifdef __SIZEOF_INT128__
+
+// The number of divsteps that suffices for inputs of 'bits' bits, by
+// Theorem 11.2 of Bernstein and Yang.
+constexpr int safegcd_iterations(int bits)
+{
+   return (bits < 46) ? (49 * bits + 80) / 17 : (49 * bits + 57) / 17;
+}
+
+constexpr int SAFEGCD_BATCH = 62;
+constexpr uint64_t SAFEGCD_LIMB_MASK = ~uint64_t(0) >> 2;
+
+// An integer of N+2 or more bits in signed 62-bit limbs: the value is the sum
+// of v[i]*2^(62*i), with v[i] in [0, 2^62) for every limb but the top one,
+// which holds the sign.
+template <int BITS>
+struct signed62 {
+   static constexpr int LIMBS = BITS / SAFEGCD_BATCH + 1;
+   int64_t v[LIMBS];
+};
+
+// 2^62 times the transition matrix of 62 divsteps: [f', g'] == [u v; q r] *
+// [f, g] / 2^62.  Every row's absolute values sum to at most 2^62.
+struct safegcd_matrix {
+   int64_t u, v, q, r;
+};
+
+
+// 62 divsteps on the low 64 bits of f and g.
+inline int64_t safegcd_divsteps_62(int64_t delta, uint64_t f, uint64_t g,
+                                   safegcd_matrix* pT)
+{
+   uint64_t u = 1, v = 0, q = 0, r = 1;   // wraps; the results fit int64_t
+   for (int i = 0; i < SAFEGCD_BATCH; ++i) {
+      assert((f & 1) == 1);
+      // c1 is all ones if g is odd, c2 if delta > 0
+      uint64_t c1 = uint64_t(0) - (g & 1);
+      uint64_t c2 = static_cast<uint64_t>((-delta) >> 63);
+      uint64_t swap = c1 & c2;
+      // on a swap: delta = -delta, (f, g) = (g, -f), (u, v, q, r) = (q, r, -u, -v)
+      delta = static_cast<int64_t>((static_cast<uint64_t>(delta) ^ swap) - swap);
+      uint64_t t = (f ^ g) & swap;
+      f ^= t;
+      g = ((g ^ t) ^ swap) - swap;
+      t = (u ^ q) & swap;
+      u ^= t;
+      q = ((q ^ t) ^ swap) - swap;
+      t = (v ^ r) & swap;
+      v ^= t;
+      r = ((r ^ t) ^ swap) - swap;
+      // then the step proper: g = (g + (g&1)*f)/2, with u, v doubled instead
+      delta += 1;
+      g = (g + (f & c1)) >> 1;
+      q += u & c1;
+      r += v & c1;
+      u <<= 1;
+      v <<= 1;
+   }
+   pT->u = static_cast<int64_t>(u);
+   pT->v = static_cast<int64_t>(v);
+   pT->q = static_cast<int64_t>(q);
+   pT->r = static_cast<int64_t>(r);
+   return delta;
+}
+
+// [f, g] = T*[f, g] / 2^62, which is exact.
+template <int BITS>
+void safegcd_update_fg(signed62<BITS>* f, signed62<BITS>* g, const safegcd_matrix& T)
+{
+   constexpr int L = signed62<BITS>::LIMBS;
+   __int128 cf = static_cast<__int128>(T.u) * f->v[0] + static_cast<__int128>(T.v) * g->v[0];
+   __int128 cg = static_cast<__int128>(T.q) * f->v[0] + static_cast<__int128>(T.r) * g->v[0];
+   assert((static_cast<uint64_t>(cf) & SAFEGCD_LIMB_MASK) == 0);
+   assert((static_cast<uint64_t>(cg) & SAFEGCD_LIMB_MASK) == 0);
+   cf >>= SAFEGCD_BATCH;
+   cg >>= SAFEGCD_BATCH;
+   for (int i = 1; i < L; ++i) {
+      cf += static_cast<__int128>(T.u) * f->v[i] + static_cast<__int128>(T.v) * g->v[i];
+      cg += static_cast<__int128>(T.q) * f->v[i] + static_cast<__int128>(T.r) * g->v[i];
+      f->v[i - 1] = static_cast<int64_t>(static_cast<uint64_t>(cf) & SAFEGCD_LIMB_MASK);
+      g->v[i - 1] = static_cast<int64_t>(static_cast<uint64_t>(cg) & SAFEGCD_LIMB_MASK);
+      cf >>= SAFEGCD_BATCH;
+      cg >>= SAFEGCD_BATCH;
+   }
+   f->v[L - 1] = static_cast<int64_t>(cf);
+   g->v[L - 1] = static_cast<int64_t>(cg);
+}
+
+// [d, e] = (T*[d, e] + m*[md, me]) / 2^62, with md and me chosen to make the
+// division exact; m is odd and mInv62 is its inverse modulo 2^62.  For d and e
+// in (-2m, m) the results are again in (-2m, m).
+template <int BITS>
+void safegcd_update_de(signed62<BITS>* d, signed62<BITS>* e, const safegcd_matrix& T,
+                       const signed62<BITS>& m, uint64_t mInv62)
+{
+   constexpr int L = signed62<BITS>::LIMBS;
+   // md, me start as the multiples of m that cancel a negative d or e
+   int64_t sd = d->v[L - 1] >> 63, se = e->v[L - 1] >> 63;
+   int64_t md = (T.u & sd) + (T.v & se);
+   int64_t me = (T.q & sd) + (T.r & se);
+   __int128 cd = static_cast<__int128>(T.u) * d->v[0] + static_cast<__int128>(T.v) * e->v[0];
+   __int128 ce = static_cast<__int128>(T.q) * d->v[0] + static_cast<__int128>(T.r) * e->v[0];
+   md -= static_cast<int64_t>((mInv62 * static_cast<uint64_t>(cd) + static_cast<uint64_t>(md)) & SAFEGCD_LIMB_MASK);
+   me -= static_cast<int64_t>((mInv62 * static_cast<uint64_t>(ce) + static_cast<uint64_t>(me)) & SAFEGCD_LIMB_MASK);
+   cd += static_cast<__int128>(m.v[0]) * md;
+   ce += static_cast<__int128>(m.v[0]) * me;
+   assert((static_cast<uint64_t>(cd) & SAFEGCD_LIMB_MASK) == 0);
+   assert((static_cast<uint64_t>(ce) & SAFEGCD_LIMB_MASK) == 0);
+   cd >>= SAFEGCD_BATCH;
+   ce >>= SAFEGCD_BATCH;
+   for (int i = 1; i < L; ++i) {
+      cd += static_cast<__int128>(T.u) * d->v[i] + static_cast<__int128>(T.v) * e->v[i];
+      ce += static_cast<__int128>(T.q) * d->v[i] + static_cast<__int128>(T.r) * e->v[i];
+      cd += static_cast<__int128>(m.v[i]) * md;
+      ce += static_cast<__int128>(m.v[i]) * me;
+      d->v[i - 1] = static_cast<int64_t>(static_cast<uint64_t>(cd) & SAFEGCD_LIMB_MASK);
+      e->v[i - 1] = static_cast<int64_t>(static_cast<uint64_t>(ce) & SAFEGCD_LIMB_MASK);
+      cd >>= SAFEGCD_BATCH;
+      ce >>= SAFEGCD_BATCH;
+   }
+   d->v[L - 1] = static_cast<int64_t>(cd);
+   e->v[L - 1] = static_cast<int64_t>(ce);
+}
+
+// x + (m & mask), then the carries propagated so that every
+// limb but the top one is again in [0, 2^62)
+template <int BITS>
+void safegcd_add_masked(signed62<BITS>* x, const signed62<BITS>& m, int64_t mask)
+{
+   constexpr int L = signed62<BITS>::LIMBS;
+   int64_t carry = 0;
+   for (int i = 0; i < L - 1; ++i) {
+      int64_t t = x->v[i] + (m.v[i] & mask) + carry;
+      x->v[i] = static_cast<int64_t>(static_cast<uint64_t>(t) & SAFEGCD_LIMB_MASK);
+      carry = t >> SAFEGCD_BATCH;
+   }
+   x->v[L - 1] += (m.v[L - 1] & mask) + carry;
+}
+
+// -x if mask is all ones, with the carries propagated
+template <int BITS>
+void safegcd_negate_masked(signed62<BITS>* x, int64_t mask)
+{
+   constexpr int L = signed62<BITS>::LIMBS;
+   int64_t carry = 0;
+   for (int i = 0; i < L - 1; ++i) {
+      int64_t t = (x->v[i] ^ mask) - mask + carry;
+      x->v[i] = static_cast<int64_t>(static_cast<uint64_t>(t) & SAFEGCD_LIMB_MASK);
+      carry = t >> SAFEGCD_BATCH;
+   }
+   x->v[L - 1] = (x->v[L - 1] ^ mask) - mask + carry;
+}
+
+template <int BITS, class U>
+signed62<BITS> to_signed62(const U& a)
+{
+   signed62<BITS> r;
+   for (int i = 0; i < signed62<BITS>::LIMBS; ++i) {
+      r.v[i] = (SAFEGCD_BATCH * i < BITS)
+               ? static_cast<int64_t>(static_cast<uint64_t>(a >> (SAFEGCD_BATCH * i)) & SAFEGCD_LIMB_MASK)
+               : 0;
+   }
+   return r;
+}
+
+// the value modulo 2^BITS
+template <int BITS, class U>
+U from_signed62(const signed62<BITS>& a)
+{
+   U r = 0;
+   for (int i = 0; i < signed62<BITS>::LIMBS; ++i) {
+      if (SAFEGCD_BATCH * i < BITS)
+         r = static_cast<U>(r | (static_cast<U>(static_cast<uint64_t>(a.v[i])) << (SAFEGCD_BATCH * i)));
+   }
+   return r;
+}
+
+
+// Runs the divsteps on f = m (odd), g = a, and returns gcd(a, m) as f and the
+// coefficient d in [0, m) with d*a == gcd (mod m).
+template <class U>
+void safegcd_divsteps(const U a, const U m, U* pGcd, U* pD)
+{
+   constexpr int BITS = std::numeric_limits<U>::digits;
+   constexpr int BATCHES = (safegcd_iterations(BITS) + SAFEGCD_BATCH - 1) / SAFEGCD_BATCH;
+   constexpr int L = signed62<BITS>::LIMBS;
+   assert((static_cast<uint64_t>(m) & 1) == 1);
+   signed62<BITS> f = to_signed62<BITS>(m), g = to_signed62<BITS>(a);
+   const signed62<BITS> mm = f;
+   signed62<BITS> d = {}, e = {};
+   e.v[0] = 1;
+   const uint64_t mInv62 = inverse_mod_word(static_cast<uint64_t>(m)) & SAFEGCD_LIMB_MASK;
+   int64_t delta = 1;
+   for (int i = 0; i < BATCHES; ++i) {
+      safegcd_matrix T;
+      uint64_t f64 = static_cast<uint64_t>(f.v[0]), g64 = static_cast<uint64_t>(g.v[0]);
+      if constexpr (L > 1) {
+         f64 |= static_cast<uint64_t>(f.v[1]) << SAFEGCD_BATCH;
+         g64 |= static_cast<uint64_t>(g.v[1]) << SAFEGCD_BATCH;
+      }
+      delta = safegcd_divsteps_62(delta, f64, g64, &T);
+      safegcd_update_fg(&f, &g, T);
+      safegcd_update_de(&d, &e, T, mm, mInv62);
+   }
+   // now g == 0 and f == +-gcd; make f positive, with d following its sign,
+   // and bring d from (-2m, m) into [0, m)
+   int64_t signF = f.v[L - 1] >> 63;
+   safegcd_add_masked(&d, mm, d.v[L - 1] >> 63);
+   safegcd_negate_masked(&f, signF);
+   safegcd_negate_masked(&d, signF);
+   safegcd_add_masked(&d, mm, d.v[L - 1] >> 63);
+   // every integer is 0 modulo 1, but for m == 1 the above leaves d == 1
+   U dd = from_signed62<BITS, U>(d);
+   *pGcd = from_signed62<BITS, U>(f);
+   *pD = static_cast<U>(dd & static_cast<U>(U(0) - static_cast<U>(m != 1)));
+}
+
+
+// The results of unsigned_extended_euclidean(a, b), for odd b, from gcd(a, b)
+// and d in [0, b) with d*a == gcd (mod b).
+template <class S, class U>
+void extended_euclidean_from_modular(const U a, const U b, U gcd, U d,
+                                     U* pGcd, S* pX, S* pY)
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::numeric_limits<S>::digits + 1 == std::numeric_limits<U>::digits, "");
+   using P = typename std::common_type<U, unsigned int>::type;   // no int promotion
+   // x is d modulo B = b/gcd, in (-B/2, B/2); B is odd, and so is gcd
+   U B = b;
+   if (gcd != 1) {   // not taken for modular inverses
+      B = static_cast<U>(static_cast<P>(b) * inverse_mod_word(gcd));
+      d = static_cast<U>(d % B);
+   }
+   U negate = static_cast<U>(U(0) - static_cast<U>(static_cast<U>(B - d) < d));
+   U x = static_cast<U>(d - (B & negate));
+   U y = static_cast<U>((static_cast<P>(gcd) - static_cast<P>(a) * x) * inverse_mod_word(b));
+   *pX = static_cast<S>(x);
+   *pY = static_cast<S>(y);
+   *pGcd = gcd;
+}
+
+template <class S, class U>
+void safegcd_extended_euclidean(const U a, const U b, U* pGcd, S* pX, S* pY)
+{
+   assert((static_cast<uint64_t>(b) & 1) == 1);   // precondition: b is odd
+   U gcd, d;
+   safegcd_divsteps(a, b, &gcd, &d);
+   extended_euclidean_from_modular(a, b, gcd, d, pGcd, pX, pY);
+}
+
+// The inverse of a modulo odd m, in [0, m), or 0 if gcd(a, m) != 1.
+template <class U>
+U safegcd_inverse(const U a, const U m)
+{
+   U gcd, d;
+   safegcd_divsteps(a, m, &gcd, &d);
+   return static_cast<U>(d & static_cast<U>(U(0) - static_cast<U>(gcd == 1)));
+}
+
+#endif
+
+#endif
@@ -0,0 +1,94 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// The extended Euclidean algorithm for signed inputs of any sign, including
+// numeric_limits<S>::min().  signed_extended_euclidean() and the proofs all
+// require a >= 0 && b >= 0; this entry point has no precondition.
+//
+// It runs unsigned_extended_euclidean() on the magnitudes |a| and |b|, which
+// always fit U (|min()| is 2^(N-1) for N bit S), and then gives x the sign of
+// a and y the sign of b.  The magnitudes and the sign fix-ups are branch-free.
+// Postconditions, for the magnitudes |a| and |b| as U:
+//
+//    gcd == gcd(|a|,|b|)                    (returned as U, since gcd(min(),0)
+//                                           == 2^(N-1) doesn't fit S)
+//    a*x + b*y == gcd                        (exactly, not just modulo 2^N)
+//    abs(x) <= max(1,|b|/2)
+//    abs(y) <= max(1,|a|/2)
+//
+// The bounds are those of final_bounds.h applied to (|a|,|b|), and negating a
+// coefficient leaves its magnitude unchanged.  Since |a|,|b| <= 2^(N-1), both
+// coefficients are at most max(1,2^(N-2)) in magnitude, so they and their
+// negations fit S.  As in unsigned_extended_euclidean(), b == 0 gives
+// (|a|, sign(a), 0) with sign(0) == 1, and a == 0 (with b != 0) gives
+// (|b|, 0, sign(b)).
+
+#ifndef SIGNED_INPUT_EXTENDED_EUCLIDEAN
+#define SIGNED_INPUT_EXTENDED_EUCLIDEAN 1
+
+#include "unsigned_extended_euclidean.h"
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <assert.h>
+
+
+// all ones if v < 0, else zero
+template <class S>
+typename std::make_unsigned<S>::type sign_mask(const S v)
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   using U = typename std::make_unsigned<S>::type;
+   return static_cast<U>(v >> std::numeric_limits<S>::digits);
+}
+
+// (v ^ mask) - mask: v if mask is zero, -v (modulo 2^N) if mask is all ones
+template <class U>
+U conditional_negate(const U v, const U mask)
+{
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   using P = typename std::common_type<U, unsigned int>::type;   // no int promotion
+   return static_cast<U>((static_cast<P>(v) ^ mask) - static_cast<P>(mask));
+}
+
+// |v| as U, correct for v == numeric_limits<S>::min()
+template <class S>
+typename std::make_unsigned<S>::type unsigned_magnitude(const S v)
+{
+   using U = typename std::make_unsigned<S>::type;
+   return conditional_negate(static_cast<U>(v), sign_mask(v));
+}
+
+
+template <class S, class U>
+void signed_input_extended_euclidean(const S a, const S b, U* pGcd, S* pX, S* pY)
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+   const U maskA = sign_mask(a), maskB = sign_mask(b);
+   const U absA = conditional_negate(static_cast<U>(a), maskA);
+   const U absB = conditional_negate(static_cast<U>(b), maskB);
+   U gcd;
+   S x, y;
+   unsigned_extended_euclidean(absA, absB, &gcd, &x, &y);
+   x = static_cast<S>(conditional_negate(static_cast<U>(x), maskA));
+   y = static_cast<S>(conditional_negate(static_cast<U>(y), maskB));
+
+#ifndef NDEBUG
+   using P = typename std::common_type<U, unsigned int>::type;   // no int promotion
+   assert(static_cast<U>(static_cast<P>(static_cast<U>(a)) * static_cast<U>(x) +
+                         static_cast<P>(static_cast<U>(b)) * static_cast<U>(y)) == gcd);
+   assert(unsigned_magnitude(x) <= std::max<U>(1, absB/2));
+   assert(unsigned_magnitude(y) <= std::max<U>(1, absA/2));
+#endif
+   *pX = x;
+   *pY = y;
+   *pGcd = gcd;
+}
+
+#endif
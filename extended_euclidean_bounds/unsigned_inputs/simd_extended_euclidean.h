@@ -0,0 +1,139 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// SIMD batched kernels for inputs of at most 32 bits, compiled for AVX2 and
+// for AVX-512 by means of function target attributes, so that the rest of the
+// program needn't be built for either.  Only call a kernel when the host
+// supports it (see cpu_features.h and extended_euclidean_dispatch.h).
+//
+// The kernels run the loop of unsigned_extended_euclidean() on W problems at
+// a time, one per SIMD lane, entirely in double precision.  Every value of
+// the loop is an integer of magnitude at most 2^32, so doubles represent
+// them, and all products and differences the loop forms, exactly.  Only the
+// quotient is inexact: fl(a0/a1) rounded to an integer is never below the
+// true quotient and at most one above it, in which case the remainder
+// a0 - q*a1 comes out negative and the lane corrects both.  A lane whose
+// problem has finished keeps its state while the others continue; the block
+// ends when every lane has finished.
+//
+// For every i < n, the results pGcd[i], pX[i], pY[i] are identical to those
+// of unsigned_extended_euclidean(a[i], b[i], ...).
+
+#ifndef SIMD_EXTENDED_EUCLIDEAN
+#define SIMD_EXTENDED_EUCLIDEAN 1
+
+#include "cpu_features.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#define SIMD_EXTENDED_EUCLIDEAN_X86 CPU_FEATURES_X86
+
+
+#if SIMD_EXTENDED_EUCLIDEAN_X86
+// GCC vector types of VL doubles
+template <int VL> struct simd_vector_types;
+template <> struct simd_vector_types<4> {
+   typedef double vec __attribute__((vector_size(32)));
+};
+template <> struct simd_vector_types<8> {
+   typedef double vec __attribute__((vector_size(64)));
+};
+
+
+// Runs blocks of NV vectors of VL lanes each.  Inlined into the
+// target-specific wrappers below, which compile its vector operations for
+// their instruction sets.
+template <int VL, int NV, class S, class U>
+__attribute__((always_inline)) inline
+void simd_extended_euclidean_blocks(const U* a, const U* b, std::size_t n,
+                                    U* pGcd, S* pX, S* pY)
+{
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+   static_assert(std::numeric_limits<U>::digits <= 32, "");
+   using vec = typename simd_vector_types<VL>::vec;
+   constexpr int W = VL * NV;
+   // adding and subtracting 1.5 * 2^52 rounds a double in [0, 2^51] to the
+   // nearest integer, which like floor() is at most one above the quotient
+   const double ROUND = 6755399441055744.0;
+
+   for (std::size_t base = 0; base < n; base += W) {
+      const int count = static_cast<int>(std::min<std::size_t>(W, n - base));
+      // the loop state of unsigned_extended_euclidean(), one lane per problem;
+      // unused lanes of the last block solve (0, 0), which needs no steps
+      vec x1[NV], y1[NV], a1[NV], x0[NV], y0[NV], a2[NV], q[NV];
+      for (int v = 0; v < NV; ++v) {
+         vec zero = {};
+         x1[v] = zero + 1.0; y1[v] = zero; a1[v] = zero;
+         x0[v] = zero; y0[v] = zero + 1.0; a2[v] = zero; q[v] = zero;
+      }
+      for (int l = 0; l < count; ++l) {
+         a1[l / VL][l % VL] = static_cast<double>(a[base + l]);
+         a2[l / VL][l % VL] = static_cast<double>(b[base + l]);
+      }
+
+      for (;;) {
+         vec remaining = {};
+         for (int v = 0; v < NV; ++v) {
+            // the lane mask is written out in every select, and never
+            // stored as a vector of integers, which GCC doesn't vectorize
+            // well for AVX-512
+            const vec oldA2 = a2[v];
+            const vec d = (oldA2 != 0.0) ? oldA2 : oldA2 + 1.0;
+            const vec x2 = x0[v] - q[v]*x1[v];
+            const vec y2 = y0[v] - q[v]*y1[v];
+            const vec a0 = a1[v];
+            vec nq = (a0/d + ROUND) - ROUND;
+            vec r = a0 - nq*d;
+            nq = (r < 0.0) ? nq - 1.0 : nq;
+            r = (r < 0.0) ? r + d : r;
+            x0[v] = (oldA2 != 0.0) ? x1[v] : x0[v];
+            y0[v] = (oldA2 != 0.0) ? y1[v] : y0[v];
+            x1[v] = (oldA2 != 0.0) ? x2 : x1[v];
+            y1[v] = (oldA2 != 0.0) ? y2 : y1[v];
+            a1[v] = (oldA2 != 0.0) ? d : a1[v];
+            q[v] = (oldA2 != 0.0) ? nq : q[v];
+            a2[v] = (oldA2 != 0.0) ? r : oldA2;
+            remaining += a2[v];   // a2 >= 0, so a lane sums to 0 iff all do
+         }
+         bool done = true;
+         for (int l = 0; l < VL; ++l)
+            done = done && (remaining[l] == 0.0);
+         if (done)
+            break;
+      }
+
+      for (int l = 0; l < count; ++l) {
+         pGcd[base + l] = static_cast<U>(static_cast<uint32_t>(a1[l / VL][l % VL]));
+         pX[base + l] = static_cast<S>(static_cast<int32_t>(x1[l / VL][l % VL]));
+         pY[base + l] = static_cast<S>(static_cast<int32_t>(y1[l / VL][l % VL]));
+      }
+   }
+}
+
+
+template <class S, class U>
+__attribute__((target("avx2,fma")))
+void simd_extended_euclidean_avx2(const U* a, const U* b, std::size_t n,
+                                  U* pGcd, S* pX, S* pY)
+{
+   simd_extended_euclidean_blocks<4, 2, S, U>(a, b, n, pGcd, pX, pY);
+}
+
+
+template <class S, class U>
+__attribute__((target("avx512f")))
+void simd_extended_euclidean_avx512(const U* a, const U* b, std::size_t n,
+                                    U* pGcd, S* pX, S* pY)
+{
+   simd_extended_euclidean_blocks<8, 2, S, U>(a, b, n, pGcd, pX, pY);
+}
+#endif
+
+#endif
@@ -0,0 +1,314 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Differential test of unsigned_extended_euclidean<int64_t, uint64_t> against
+// a reference of signed_extended_euclidean<__int128>.  test_unsigned() in
+// test_unsigned_extended_euclidean.cpp uses int64_t for its reference, which
+// can't represent uint64_t inputs; __int128 can.  Every scalar engine of
+// extended_euclidean_autotune.h (the variants of
+// extended_euclidean_variants.h) is checked against it too: on every
+// structured pair, and on one random pair in ENGINE_SAMPLE, so that the
+// random tests keep the reference loop's throughput.
+//
+// The test first checks all pairs of a set of edge values and the pairs of
+// adversarial_pairs (input_generators.h), and then compares randomly
+// generated pairs on every thread until the time limit expires.  Thread k
+// draws its pairs from stream k of the seed (see fast_prng.h), so any
+// mismatch is reproducible from the printed seed, and the failing pair can
+// be rerun alone with --pair.
+//
+// Usage: test_unsigned_64bit_differential [--seconds N] [--threads N]
+//                                          [--seed N] [--pair A B]
+
+#include "unsigned_extended_euclidean.h"
+#include "signed_extended_euclidean.h"
+#include "extended_euclidean_autotune.h"
+#include "fast_prng.h"
+#include "input_generators.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using S = int64_t;
+using U = uint64_t;
+using T = __int128;
+
+static_assert(std::numeric_limits<T>::is_integer,
+              "__int128 must be an integer type (use the GNU dialect of C++)");
+static_assert(std::numeric_limits<T>::is_signed, "");
+
+
+std::string to_string_128(T value)
+{
+   if (value == 0)
+       return "0";
+   bool negative = (value < 0);
+   unsigned __int128 magnitude = negative ?
+                  -static_cast<unsigned __int128>(value) :
+                   static_cast<unsigned __int128>(value);
+   std::string digits;
+   while (magnitude != 0) {
+       digits.insert(digits.begin(), static_cast<char>('0' + magnitude % 10));
+       magnitude /= 10;
+   }
+   return negative ? "-" + digits : digits;
+}
+
+
+// the random tests check the scalar engines on one pair in ENGINE_SAMPLE
+constexpr uint64_t ENGINE_SAMPLE = 64;
+
+
+// returns true if the engine's results agree with the reference for (a, b)
+inline bool agrees(U a, U b)
+{
+   U gcd;
+   S x, y;
+   T gcd2, x2, y2;
+   unsigned_extended_euclidean(a, b, &gcd, &x, &y);
+   signed_extended_euclidean<T>(a, b, &gcd2, &x2, &y2);
+   return (gcd == gcd2 && x == x2 && y == y2);
+}
+
+// returns true if every scalar engine's results agree with those of
+// unsigned_extended_euclidean() for (a, b)
+inline bool engines_agree(U a, U b)
+{
+   U gcd;
+   S x, y;
+   unsigned_extended_euclidean(a, b, &gcd, &x, &y);
+   for (const scalar_engine<S, U>& engine : scalar_engines<S, U>()) {
+       U gcd3;
+       S x3, y3;
+       engine.function(a, b, &gcd3, &x3, &y3);
+       if (gcd3 != gcd || x3 != x || y3 != y)
+           return false;
+   }
+   return true;
+}
+
+
+void print_mismatch(U a, U b)
+{
+   U gcd;
+   S x, y;
+   T gcd2, x2, y2;
+   unsigned_extended_euclidean(a, b, &gcd, &x, &y);
+   signed_extended_euclidean<T>(a, b, &gcd2, &x2, &y2);
+   std::cout << "test failed: a == " << a << ", b == " << b << "\n"
+             << "   unsigned_extended_euclidean: gcd == " << gcd
+             << ", x == " << x << ", y == " << y << "\n"
+             << "   reference (__int128):        gcd == " << to_string_128(gcd2)
+             << ", x == " << to_string_128(x2)
+             << ", y == " << to_string_128(y2) << "\n";
+   for (const scalar_engine<S, U>& engine : scalar_engines<S, U>()) {
+       U gcd3;
+       S x3, y3;
+       engine.function(a, b, &gcd3, &x3, &y3);
+       if (gcd3 != gcd || x3 != x || y3 != y)
+           std::cout << "   engine " << engine.name << ": gcd == " << gcd3
+                     << ", x == " << x3 << ", y == " << y3 << "\n";
+   }
+}
+
+
+int structured_tests()
+{
+   constexpr U max = std::numeric_limits<U>::max();
+   std::vector<U> edges;
+   for (U i = 0; i <= 5; ++i) {
+       edges.push_back(i);
+       edges.push_back(max - i);
+       edges.push_back(max/2 - i);
+       edges.push_back(max/2 + 1 + i);
+   }
+   for (int shift = 2; shift < 64; ++shift) {
+       U p = static_cast<U>(1) << shift;
+       edges.push_back(p - 1);
+       edges.push_back(p);
+       edges.push_back(p + 1);
+   }
+   uint64_t count = 0;
+   for (U a : edges) {
+       for (U b : edges) {
+           if (!agrees(a, b) || !engines_agree(a, b)) {
+               print_mismatch(a, b);
+               return 1;
+           }
+           ++count;
+       }
+   }
+   // inputs structured to stress the algorithm (Fibonacci pairs, huge
+   // quotients, large gcds, values near powers of two, scaled pairs)
+   adversarial_pairs<U> adversarial;
+   U a, b;
+   while (adversarial.next(&a, &b)) {
+       if (!agrees(a, b) || !engines_agree(a, b)) {
+           print_mismatch(a, b);
+           return 1;
+       }
+       ++count;
+   }
+   std::cout << "Passed structured tests (" << count << " pairs).\n";
+   return 0;
+}
+
+
+// Draws the next test pair from a thread's stream.  Most pairs have random
+// bit lengths, so that quotients of all sizes occur; some are uniform over
+// the full range, and some share a large common factor.
+inline void next_pair(xoshiro256ss* pRng, U* pA, U* pB)
+{
+   uint64_t selector = pRng->next() & 7;
+   if (selector == 0) {
+       *pA = pRng->next();
+       *pB = pRng->next();
+   } else if (selector == 1) {
+       U k = (pRng->next() >> 40) | 1;
+       *pA = (pRng->next() >> 24) * k;
+       *pB = (pRng->next() >> 24) * k;
+   } else {
+       *pA = pRng->next_random_length();
+       *pB = pRng->next_random_length();
+   }
+}
+
+
+struct mismatch_report {
+   std::mutex mutex;
+   bool found = false;
+   unsigned int stream = 0;
+   uint64_t index = 0;
+   U a = 0, b = 0;
+};
+
+
+void random_test_thread(uint64_t seed, unsigned int stream,
+                        std::chrono::steady_clock::time_point deadline,
+                        std::atomic<bool>* pStop, uint64_t* pCount,
+                        mismatch_report* pReport)
+{
+   constexpr uint64_t BLOCK = 1 << 16;
+   xoshiro256ss rng(seed, stream);
+   uint64_t index = 0;
+   while (!pStop->load(std::memory_order_relaxed)) {
+       for (uint64_t i = 0; i < BLOCK; ++i, ++index) {
+           U a, b;
+           next_pair(&rng, &a, &b);
+           if (!agrees(a, b) ||
+                   (index % ENGINE_SAMPLE == 0 && !engines_agree(a, b))) {
+               std::lock_guard<std::mutex> lock(pReport->mutex);
+               if (!pReport->found) {
+                   pReport->found = true;
+                   pReport->stream = stream;
+                   pReport->index = index;
+                   pReport->a = a;
+                   pReport->b = b;
+               }
+               pStop->store(true);
+               break;
+           }
+       }
+       if (std::chrono::steady_clock::now() >= deadline)
+           break;
+   }
+   *pCount = index;
+}
+
+
+int random_tests(uint64_t seed, unsigned int numThreads, double seconds)
+{
+   std::cout << "Running random tests with --seed " << seed << " on "
+             << numThreads << " thread(s) for " << seconds << " seconds.\n";
+   auto start = std::chrono::steady_clock::now();
+   auto deadline = start + std::chrono::duration_cast<
+                       std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double>(seconds));
+   std::atomic<bool> stop(false);
+   std::vector<uint64_t> counts(numThreads);
+   mismatch_report report;
+   std::vector<std::thread> threads;
+   for (unsigned int t = 0; t < numThreads; ++t)
+       threads.emplace_back(random_test_thread, seed, t, deadline, &stop,
+                            &counts[t], &report);
+   for (auto& thread : threads)
+       thread.join();
+   double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start).count();
+
+   uint64_t total = 0, sampled = 0;
+   for (uint64_t count : counts) {
+       total += count;
+       sampled += (count + ENGINE_SAMPLE - 1) / ENGINE_SAMPLE;
+   }
+   // one comparison with the reference per pair, and one per engine for
+   // each sampled pair
+   uint64_t comparisons = total + sampled * scalar_engines<S, U>().size();
+   if (report.found) {
+       print_mismatch(report.a, report.b);
+       std::cout << "   found by stream " << report.stream << " at index "
+                 << report.index << " of --seed " << seed << "\n"
+                 << "   rerun with: --pair " << report.a << " " << report.b
+                 << "\n";
+       return 1;
+   }
+   std::cout << "Passed random tests (" << total << " pairs, " << sampled
+             << " of them checked on every engine, "
+             << static_cast<uint64_t>(comparisons / elapsed * 60.0)
+             << " comparisons per minute).\n";
+   return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+   std::cout << "***Test 64 bit Unsigned Extended Euclidean Against __int128"
+                " Reference***\n\n";
+
+   double seconds = 10.0;
+   unsigned int numThreads = std::thread::hardware_concurrency();
+   uint64_t seed = static_cast<uint64_t>(
+              std::chrono::high_resolution_clock::now().time_since_epoch()
+              .count());
+   for (int i = 1; i < argc; ++i) {
+       if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+           seconds = std::strtod(argv[++i], nullptr);
+       } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+           numThreads = static_cast<unsigned int>(
+                                   std::strtoul(argv[++i], nullptr, 10));
+       } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+           seed = std::strtoull(argv[++i], nullptr, 10);
+       } else if (std::strcmp(argv[i], "--pair") == 0 && i + 2 < argc) {
+           U a = std::strtoull(argv[++i], nullptr, 10);
+           U b = std::strtoull(argv[++i], nullptr, 10);
+           if (!agrees(a, b) || !engines_agree(a, b)) {
+               print_mismatch(a, b);
+               return 1;
+           }
+           std::cout << "Passed: a == " << a << ", b == " << b << "\n";
+           return 0;
+       } else {
+           std::cout << "unknown or incomplete option: " << argv[i] << "\n";
+           return 1;
+       }
+   }
+   if (numThreads == 0)
+       numThreads = 1;
+
+   if (structured_tests() != 0)
+       return 1;
+   if (random_tests(seed, numThreads, seconds) != 0)
+       return 1;
+
+   std::cout << "\n*** Passed all tests ***\n";
+   return 0;
+}
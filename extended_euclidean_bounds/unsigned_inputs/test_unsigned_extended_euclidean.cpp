@@ -2,11 +2,27 @@
 // in the file "LICENSE.TXT" in the root of this repository ---
 
 #include "unsigned_extended_euclidean.h"
+#include "interleaved_extended_euclidean.h"
+#include "parallel_extended_euclidean.h"
+#include "extended_euclidean_dispatch.h"
+#include "extended_euclidean_autotune.h"
 #include "signed_extended_euclidean.h"
+#include "signed_input_extended_euclidean.h"
+#include "continued_fraction.h"
+#include "jacobi_symbol.h"
+#include "montgomery_context.h"
+#include "optimized_binary_gcd.h"
+#include "safegcd_extended_euclidean.h"
+#include "fixed_width_integer.h"
+#include "input_generators.h"
 #include <type_traits>
 #include <iostream>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <limits>
+#include <string>
+#include <vector>
 
 
 template <class S, class U, class T>
@@ -18,7 +34,7 @@ int test_unsigned(U a, U b)
    static_assert(std::numeric_limits<S>::is_signed, "");
    static_assert(std::numeric_limits<U>::is_integer, "");
    static_assert(!(std::numeric_limits<U>::is_signed), "");
-   static_assert(std::is_same<std::make_signed<U>::type, S>::value, "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
    U gcd;
    S x, y;
    T gcd2, x2, y2;
@@ -158,6 +174,1142 @@ int extreme_values_tests()
 }
 
 
+template <class S>
+int adversarial_width_tests()
+{
+   using U = typename std::make_unsigned<S>::type;
+   using T = int64_t;
+   static_assert(std::numeric_limits<T>::max() >= std::numeric_limits<U>::max(), "");
+
+   adversarial_pairs<U> pairs;
+   U a, b;
+   while (pairs.next(&a, &b)) {
+       if (0 != test_unsigned<S, U, T>(a, b))
+           return 1;
+   }
+   return 0;
+}
+
+
+int adversarial_tests()
+{
+   // test inputs structured to stress the algorithm (Fibonacci pairs, huge
+   // quotients, large gcds, values near powers of two, scaled pairs)
+   if (adversarial_width_tests<int8_t>() != 0)
+       return 1;
+   if (adversarial_width_tests<int16_t>() != 0)
+       return 1;
+   if (adversarial_width_tests<int32_t>() != 0)
+       return 1;
+
+   std::cout << "Passed adversarial input tests.\n";
+   return 0;
+}
+
+
+// Compares interleaved_extended_euclidean<LANES>() on a batch against
+// unsigned_extended_euclidean() on each pair of the batch.
+template <int LANES, class S, class U>
+int test_interleaved_batch(const std::vector<U>& a, const std::vector<U>& b)
+{
+   std::size_t n = a.size();
+   std::vector<U> gcd(n);
+   std::vector<S> x(n), y(n);
+   interleaved_extended_euclidean<LANES, S, U>(a.data(), b.data(), n,
+                                               gcd.data(), x.data(), y.data());
+   for (std::size_t i = 0; i < n; ++i) {
+       U gcd2;
+       S x2, y2;
+       unsigned_extended_euclidean(a[i], b[i], &gcd2, &x2, &y2);
+       if (gcd[i] != gcd2 || x[i] != x2 || y[i] != y2) {
+           std::cout << "interleaved test failed (LANES == " << LANES
+                     << "): a == " << +a[i] << ", b == " << +b[i] << "\n";
+           return 1;
+       }
+   }
+   return 0;
+}
+
+// Compares interleaved_extended_euclidean_strided<LANES>() against
+// unsigned_extended_euclidean(), with the inputs inStride apart and the
+// results outStride apart; the entries between them hold a filler value,
+// which must be neither read nor overwritten.
+template <int LANES, class S, class U>
+int test_interleaved_strided(const std::vector<U>& a, const std::vector<U>& b,
+                             std::size_t inStride, std::size_t outStride)
+{
+   const U fill = static_cast<U>(0x5a5a5a5a5a5a5a5au);
+   std::size_t n = a.size();
+   std::vector<U> sa(n*inStride, fill), sb(n*inStride, fill), gcd(n*outStride, fill);
+   std::vector<S> x(n*outStride, static_cast<S>(fill)), y(n*outStride, static_cast<S>(fill));
+   for (std::size_t i = 0; i < n; ++i) {
+       sa[i*inStride] = a[i];
+       sb[i*inStride] = b[i];
+   }
+   interleaved_extended_euclidean_strided<LANES, S, U>(sa.data(), sb.data(), inStride, n,
+                                                       gcd.data(), x.data(), y.data(), outStride);
+   for (std::size_t k = 0; k < n*outStride; ++k) {
+       std::size_t i = k / outStride;
+       U gcd2 = fill;
+       S x2 = static_cast<S>(fill), y2 = static_cast<S>(fill);
+       if (k % outStride == 0)
+           unsigned_extended_euclidean(a[i], b[i], &gcd2, &x2, &y2);
+       if (gcd[k] != gcd2 || x[k] != x2 || y[k] != y2) {
+           std::cout << "interleaved strided test failed (LANES == " << LANES
+                     << ", inStride == " << inStride << ", outStride == " << outStride
+                     << "): a == " << +a[i] << ", b == " << +b[i] << "\n";
+           return 1;
+       }
+   }
+   return 0;
+}
+
+
+template <class S>
+int interleaved_width_tests(const std::vector<typename std::make_unsigned<S>::type>& a,
+                            const std::vector<typename std::make_unsigned<S>::type>& b)
+{
+   using U = typename std::make_unsigned<S>::type;
+   if (0 != test_interleaved_batch<1, S, U>(a, b) ||
+           0 != test_interleaved_batch<2, S, U>(a, b) ||
+           0 != test_interleaved_batch<3, S, U>(a, b) ||
+           0 != test_interleaved_batch<8, S, U>(a, b))
+       return 1;
+   return 0;
+}
+
+template <class S>
+int interleaved_strided_tests(const std::vector<typename std::make_unsigned<S>::type>& a,
+                              const std::vector<typename std::make_unsigned<S>::type>& b)
+{
+   using U = typename std::make_unsigned<S>::type;
+   const std::size_t strides[][2] = { { 1, 1 }, { 3, 1 }, { 1, 4 }, { 2, 5 } };
+   for (const auto& stride : strides) {
+       if (0 != test_interleaved_strided<1, S, U>(a, b, stride[0], stride[1]) ||
+               0 != test_interleaved_strided<2, S, U>(a, b, stride[0], stride[1]) ||
+               0 != test_interleaved_strided<3, S, U>(a, b, stride[0], stride[1]) ||
+               0 != test_interleaved_strided<8, S, U>(a, b, stride[0], stride[1]))
+           return 1;
+   }
+   return 0;
+}
+
+
+int interleaved_tests()
+{
+   // all pairs of uint8_t values, as one batch
+   std::vector<uint8_t> a8, b8;
+   for (int a = 0; a < 256; ++a) {
+       for (int b = 0; b < 256; ++b) {
+           a8.push_back(static_cast<uint8_t>(a));
+           b8.push_back(static_cast<uint8_t>(b));
+       }
+   }
+   if (interleaved_width_tests<int8_t>(a8, b8) != 0)
+       return 1;
+
+   // adversarial and random batches of the wider types, with batch sizes
+   // that aren't multiples of the lane counts
+   std::vector<uint32_t> a32, b32;
+   std::vector<uint64_t> a64, b64;
+   adversarial_pairs<uint32_t> adversarial32;
+   adversarial_pairs<uint64_t> adversarial64;
+   uint32_t u32, v32;
+   uint64_t u64, v64;
+   while (adversarial32.next(&u32, &v32)) {
+       a32.push_back(u32);
+       b32.push_back(v32);
+   }
+   while (adversarial64.next(&u64, &v64)) {
+       a64.push_back(u64);
+       b64.push_back(v64);
+   }
+   random_pairs<uint64_t> random64(10007, 1, true);
+   while (random64.next(&u64, &v64)) {
+       a64.push_back(u64);
+       b64.push_back(v64);
+   }
+   if (interleaved_width_tests<int32_t>(a32, b32) != 0)
+       return 1;
+   if (interleaved_width_tests<int64_t>(a64, b64) != 0)
+       return 1;
+
+   // the strided engine, on random batches of 1001 pairs (not a multiple of
+   // any of the lane counts) with every fifth b == 0
+   std::vector<uint32_t> aStrided32, bStrided32;
+   std::vector<uint64_t> aStrided64, bStrided64;
+   random_pairs<uint64_t> randomStrided(1001, 3, true);
+   for (int i = 0; randomStrided.next(&u64, &v64); ++i) {
+       if (i % 5 == 0)
+           v64 = 0;
+       aStrided32.push_back(static_cast<uint32_t>(u64));
+       bStrided32.push_back(static_cast<uint32_t>(v64));
+       aStrided64.push_back(u64);
+       bStrided64.push_back(v64);
+   }
+   if (interleaved_strided_tests<int32_t>(aStrided32, bStrided32) != 0 ||
+           interleaved_strided_tests<int64_t>(aStrided64, bStrided64) != 0)
+       return 1;
+
+   std::cout << "Passed interleaved engine tests.\n";
+   return 0;
+}
+
+
+int parallel_tests()
+{
+   using S = int64_t;
+   using U = uint64_t;
+
+   // a batch size that isn't a multiple of the chunk size
+   std::vector<U> a, b;
+   random_pairs<U> random(100003, 2, true);
+   U u, v;
+   while (random.next(&u, &v)) {
+       a.push_back(u);
+       b.push_back(v);
+   }
+   std::size_t n = a.size();
+   for (unsigned int numThreads : { 1u, 3u, 8u }) {
+       work_stealing_pool pool(numThreads);
+       std::vector<U> gcd(n);
+       std::vector<S> x(n), y(n);
+       for (int repeat = 0; repeat < 3; ++repeat) {
+           parallel_extended_euclidean<S, U>(a, b, gcd, x, y, pool);
+           for (std::size_t i = 0; i < n; ++i) {
+               U gcd2;
+               S x2, y2;
+               unsigned_extended_euclidean(a[i], b[i], &gcd2, &x2, &y2);
+               if (gcd[i] != gcd2 || x[i] != x2 || y[i] != y2) {
+                   std::cout << "parallel test failed (" << numThreads
+                             << " threads): a == " << a[i] << ", b == "
+                             << b[i] << "\n";
+                   return 1;
+               }
+           }
+       }
+   }
+
+   std::cout << "Passed parallel batch tests.\n";
+   return 0;
+}
+
+// Compares every kernel the host supports, and the dispatched kernel, against
+// unsigned_extended_euclidean() on a batch.
+template <class S>
+int dispatch_width_tests(const std::vector<typename std::make_unsigned<S>::type>& a,
+                         const std::vector<typename std::make_unsigned<S>::type>& b)
+{
+   using U = typename std::make_unsigned<S>::type;
+   std::vector<batch_kernel<S, U>> kernels =
+                                supported_kernels<S, U>(host_cpu_features());
+   kernels.push_back(dispatched_kernel<S, U>());
+   std::size_t n = a.size();
+   for (const batch_kernel<S, U>& kernel : kernels) {
+       std::vector<U> gcd(n);
+       std::vector<S> x(n), y(n);
+       kernel.function(a.data(), b.data(), n, gcd.data(), x.data(), y.data());
+       for (std::size_t i = 0; i < n; ++i) {
+           U gcd2;
+           S x2, y2;
+           unsigned_extended_euclidean(a[i], b[i], &gcd2, &x2, &y2);
+           if (gcd[i] != gcd2 || x[i] != x2 || y[i] != y2) {
+               std::cout << "dispatch test failed (kernel " << kernel.name
+                         << "): a == " << +a[i] << ", b == " << +b[i] << "\n";
+               return 1;
+           }
+       }
+   }
+
+   // forcing a kernel by name, and automatic selection on a cpu without
+   // SIMD or fast 64-bit division
+   cpu_features noFeatures;
+   const char* expected = (std::numeric_limits<U>::digits > 32) ?
+                                            "interleaved8" : "interleaved4";
+   if (std::strcmp(select_kernel<S, U>(noFeatures, "scalar").name, "scalar") != 0 ||
+           std::strcmp(select_kernel<S, U>(noFeatures, nullptr).name,
+                       expected) != 0) {
+       std::cout << "dispatch test failed: wrong kernel selected\n";
+       return 1;
+   }
+   std::cout << "   " << std::numeric_limits<U>::digits << "-bit kernel: "
+             << dispatched_kernel<S, U>().name << "\n";
+   return 0;
+}
+
+
+int dispatch_tests()
+{
+   std::vector<uint8_t> a8, b8;
+   for (int a = 0; a < 256; ++a) {
+       for (int b = 0; b < 256; ++b) {
+           a8.push_back(static_cast<uint8_t>(a));
+           b8.push_back(static_cast<uint8_t>(b));
+       }
+   }
+   std::vector<uint16_t> a16, b16;
+   std::vector<uint32_t> a32, b32;
+   std::vector<uint64_t> a64, b64;
+   uint16_t u16, v16;
+   uint32_t u32, v32;
+   uint64_t u64, v64;
+   random_pairs<uint16_t> random16(100003, 3, true);
+   while (random16.next(&u16, &v16)) {
+       a16.push_back(u16);
+       b16.push_back(v16);
+   }
+   adversarial_pairs<uint32_t> adversarial32;
+   while (adversarial32.next(&u32, &v32)) {
+       a32.push_back(u32);
+       b32.push_back(v32);
+   }
+   random_pairs<uint32_t> random32(100003, 3, true);
+   while (random32.next(&u32, &v32)) {
+       a32.push_back(u32);
+       b32.push_back(v32);
+   }
+   random_pairs<uint64_t> random64(10007, 3, true);
+   while (random64.next(&u64, &v64)) {
+       a64.push_back(u64);
+       b64.push_back(v64);
+   }
+   if (dispatch_width_tests<int8_t>(a8, b8) != 0 ||
+           dispatch_width_tests<int16_t>(a16, b16) != 0 ||
+           dispatch_width_tests<int32_t>(a32, b32) != 0 ||
+           dispatch_width_tests<int64_t>(a64, b64) != 0)
+       return 1;
+
+   std::cout << "Passed kernel dispatch tests.\n";
+   return 0;
+}
+
+
+// Compares every scalar engine of the autotuner against
+// unsigned_extended_euclidean() on a batch.
+template <class S>
+int scalar_engine_width_tests(const std::vector<typename std::make_unsigned<S>::type>& a,
+                              const std::vector<typename std::make_unsigned<S>::type>& b)
+{
+   using U = typename std::make_unsigned<S>::type;
+   std::size_t n = a.size();
+   for (const scalar_engine<S, U>& engine : scalar_engines<S, U>()) {
+       std::vector<U> gcd(n);
+       std::vector<S> x(n), y(n);
+       engine.batch(a.data(), b.data(), n, gcd.data(), x.data(), y.data());
+       for (std::size_t i = 0; i < n; ++i) {
+           U gcd2, gcd3;
+           S x2, y2, x3, y3;
+           unsigned_extended_euclidean(a[i], b[i], &gcd2, &x2, &y2);
+           engine.function(a[i], b[i], &gcd3, &x3, &y3);
+           if (gcd[i] != gcd2 || x[i] != x2 || y[i] != y2 ||
+                   gcd3 != gcd2 || x3 != x2 || y3 != y2) {
+               std::cout << "scalar engine test failed (engine " << engine.name
+                         << "): a == " << +a[i] << ", b == " << +b[i] << "\n";
+               return 1;
+           }
+       }
+   }
+   return 0;
+}
+
+
+int scalar_engine_tests()
+{
+   // all pairs of uint8_t values, and all pairs of 10-bit values
+   std::vector<uint8_t> a8, b8;
+   std::vector<uint16_t> a16, b16;
+   for (int a = 0; a < 1024; ++a) {
+       for (int b = 0; b < 1024; ++b) {
+           if (a < 256 && b < 256) {
+               a8.push_back(static_cast<uint8_t>(a));
+               b8.push_back(static_cast<uint8_t>(b));
+           }
+           a16.push_back(static_cast<uint16_t>(a));
+           b16.push_back(static_cast<uint16_t>(b));
+       }
+   }
+   std::vector<uint32_t> a32, b32;
+   std::vector<uint64_t> a64, b64;
+   uint16_t u16, v16;
+   uint32_t u32, v32;
+   uint64_t u64, v64;
+   random_pairs<uint16_t> random16(100003, 4, true);
+   while (random16.next(&u16, &v16)) {
+       a16.push_back(u16);
+       b16.push_back(v16);
+   }
+   adversarial_pairs<uint32_t> adversarial32;
+   while (adversarial32.next(&u32, &v32)) {
+       a32.push_back(u32);
+       b32.push_back(v32);
+   }
+   random_pairs<uint32_t> random32(100003, 4, true);
+   while (random32.next(&u32, &v32)) {
+       a32.push_back(u32);
+       b32.push_back(v32);
+   }
+   adversarial_pairs<uint64_t> adversarial64;
+   while (adversarial64.next(&u64, &v64)) {
+       a64.push_back(u64);
+       b64.push_back(v64);
+   }
+   random_pairs<uint64_t> random64(100003, 4, true);
+   while (random64.next(&u64, &v64)) {
+       a64.push_back(u64);
+       b64.push_back(v64);
+   }
+   if (scalar_engine_width_tests<int8_t>(a8, b8) != 0 ||
+           scalar_engine_width_tests<int16_t>(a16, b16) != 0 ||
+           scalar_engine_width_tests<int32_t>(a32, b32) != 0 ||
+           scalar_engine_width_tests<int64_t>(a64, b64) != 0)
+       return 1;
+
+   std::cout << "Passed scalar engine variant tests.\n";
+   return 0;
+}
+
+
+int autotune_tests()
+{
+   using S = int32_t;
+   using U = uint32_t;
+   const char* path = "test_autotune_cache.txt";
+   std::remove(path);
+   cpu_features cpu = host_cpu_features();
+   std::string key = autotune_cache_key(cpu, 32);
+
+   // a measurement is cached, and a later lookup binds the cached engine
+   const scalar_engine<S, U>& tuned = autotune_engine<S, U>(cpu, path, true, nullptr);
+   if (read_autotune_cache(path, key) != tuned.name) {
+       std::cout << "autotune test failed: the choice wasn't cached\n";
+       return 1;
+   }
+   if (!write_autotune_cache(path, autotune_cache_key(cpu, 64), "lehmer") ||
+           !write_autotune_cache(path, key, "binary") ||
+           std::strcmp(autotune_engine<S, U>(cpu, path, false, nullptr).name,
+                       "binary") != 0 ||
+           read_autotune_cache(path, autotune_cache_key(cpu, 64)) != "lehmer") {
+       std::cout << "autotune test failed: the cached engine wasn't used\n";
+       return 1;
+   }
+   // an unknown cached engine is retuned, and a requested one is used
+   if (!write_autotune_cache(path, key, "no_such_engine") ||
+           std::strcmp(autotune_engine<S, U>(cpu, path, false,
+                                             "small_quotient").name,
+                       "small_quotient") != 0) {
+       std::cout << "autotune test failed: the requested engine wasn't used\n";
+       return 1;
+   }
+   (void)autotune_engine<S, U>(cpu, path, false, nullptr);
+   if (read_autotune_cache(path, key) == "no_such_engine") {
+       std::cout << "autotune test failed: a bad cache entry wasn't replaced\n";
+       return 1;
+   }
+
+   // routing through the bound engine
+   autotune_extended_euclidean(false, path);
+   std::remove(path);
+   random_pairs<U> random(10007, 5, true);
+   U a, b;
+   while (random.next(&a, &b)) {
+       U gcd, gcd2;
+       S x, y, x2, y2;
+       tuned_extended_euclidean<S, U>(a, b, &gcd, &x, &y);
+       unsigned_extended_euclidean(a, b, &gcd2, &x2, &y2);
+       if (gcd != gcd2 || x != x2 || y != y2) {
+           std::cout << "autotune test failed (engine " << tuned_engine_name<S, U>()
+                     << "): a == " << a << ", b == " << b << "\n";
+           return 1;
+       }
+   }
+   std::cout << "   tuned engines: " << tuned_engine_name<int8_t, uint8_t>()
+             << ", " << tuned_engine_name<int16_t, uint16_t>() << ", "
+             << tuned_engine_name<int32_t, uint32_t>() << ", "
+             << tuned_engine_name<int64_t, uint64_t>() << "\n";
+
+   std::cout << "Passed autotune tests.\n";
+   return 0;
+}
+
+
+// Checks signed_input_extended_euclidean() against its stated
+// postconditions, using a reference that normalizes the signs with branches
+// and runs signed_extended_euclidean() in 128 bit (or 64 bit) arithmetic.
+template <class S>
+int test_signed_input(S a, S b)
+{
+   using U = typename std::make_unsigned<S>::type;
+#ifdef __SIZEOF_INT128__
+   using W = __int128;
+#else
+   using W = int64_t;
+   static_assert(std::numeric_limits<U>::digits < 64, "");
+#endif
+   U gcd;
+   S x, y;
+   signed_input_extended_euclidean(a, b, &gcd, &x, &y);
+
+   W wa = a, wb = b;
+   W absA = (wa < 0) ? -wa : wa;
+   W absB = (wb < 0) ? -wb : wb;
+   W gcd2, x2, y2;
+   signed_extended_euclidean<W>(absA, absB, &gcd2, &x2, &y2);
+   if (wa < 0)
+       x2 = -x2;
+   if (wb < 0)
+       y2 = -y2;
+   W absX = (x < 0) ? -static_cast<W>(x) : static_cast<W>(x);
+   W absY = (y < 0) ? -static_cast<W>(y) : static_cast<W>(y);
+   if (static_cast<W>(gcd) != gcd2 || x != x2 || y != y2 ||
+           wa*x + wb*y != gcd2 ||
+           absX > std::max<W>(1, absB/2) || absY > std::max<W>(1, absA/2)) {
+       std::cout << "signed input test failed: a == " << static_cast<int64_t>(a)
+                 << ", b == " << static_cast<int64_t>(b) << "\n";
+       return 1;
+   }
+   return 0;
+}
+
+template <class S>
+int signed_input_width_tests()
+{
+   using U = typename std::make_unsigned<S>::type;
+   constexpr S min = std::numeric_limits<S>::min();
+   constexpr S max = std::numeric_limits<S>::max();
+   const S edges[] = { min, static_cast<S>(min + 1), static_cast<S>(min/2),
+                       -2, -1, 0, 1, 2, static_cast<S>(max/2),
+                       static_cast<S>(max - 1), max };
+   for (S a : edges)
+       for (S b : edges)
+           if (0 != test_signed_input(a, b))
+               return 1;
+
+   // every sign combination of the adversarial pairs that fit S, and of
+   // uniformly random pairs (whose top bits give random signs)
+   adversarial_pairs<U> pairs;
+   U ua, ub;
+   while (pairs.next(&ua, &ub)) {
+       if (ua > static_cast<U>(max) || ub > static_cast<U>(max))
+           continue;
+       S a = static_cast<S>(ua), b = static_cast<S>(ub);
+       if (0 != test_signed_input<S>(a, b) ||
+               0 != test_signed_input<S>(static_cast<S>(-a), b) ||
+               0 != test_signed_input<S>(a, static_cast<S>(-b)) ||
+               0 != test_signed_input<S>(static_cast<S>(-a), static_cast<S>(-b)))
+           return 1;
+   }
+   random_pairs<U> random(100003, 11);
+   while (random.next(&ua, &ub)) {
+       if (0 != test_signed_input(static_cast<S>(ua), static_cast<S>(ub)))
+           return 1;
+   }
+   return 0;
+}
+
+
+int signed_input_tests()
+{
+   // every pair of int8_t values, including -128
+   for (int a = -128; a <= 127; ++a) {
+       for (int b = -128; b <= 127; ++b)
+           if (0 != test_signed_input(static_cast<int8_t>(a), static_cast<int8_t>(b)))
+               return 1;
+   }
+   // every int16_t value paired with the extreme values, in both orders
+   const int16_t extremes[] = { -32768, -32767, -1, 0, 1, 32767 };
+   for (int a = -32768; a <= 32767; ++a) {
+       for (int16_t b : extremes)
+           if (0 != test_signed_input(static_cast<int16_t>(a), b) ||
+                   0 != test_signed_input(b, static_cast<int16_t>(a)))
+               return 1;
+   }
+   if (signed_input_width_tests<int16_t>() != 0 ||
+           signed_input_width_tests<int32_t>() != 0)
+       return 1;
+#ifdef __SIZEOF_INT128__
+   if (signed_input_width_tests<int64_t>() != 0)
+       return 1;
+#endif
+
+   std::cout << "Passed signed input tests.\n";
+   return 0;
+}
+
+
+// hexadecimal, for any of the unsigned types
+template <class U>
+std::string hex_string(U v)
+{
+   std::string s;
+   do {
+       s.insert(s.begin(), "0123456789abcdef"[static_cast<unsigned int>(v & 15u)]);
+       v = static_cast<U>(v >> 4);
+   } while (v != 0);
+   return "0x" + s;
+}
+
+
+#ifdef __SIZEOF_INT128__
+// the fixed width integers and the engines for odd moduli need __int128
+
+int fixed_width_tests()
+{
+   // fixed_uint<2> and fixed_int<2> against the native 128 bit types
+   using F = fixed_uint<2>;
+   using SF = fixed_int<2>;
+   using u128 = unsigned __int128;
+   auto native = [](const F& v) {
+         return (static_cast<u128>(v.limb[1]) << 64) | v.limb[0];
+      };
+   xoshiro256ss rng(17);
+   for (int i = 0; i < 200000; ++i) {
+       // operands of random lengths, so that divisors of one and two digits
+       // are both tested
+       F a, b;
+       a.limb[0] = rng.next_random_length();
+       a.limb[1] = (i & 1) ? rng.next_random_length() : 0;
+       b.limb[0] = rng.next_random_length();
+       b.limb[1] = (i & 2) ? rng.next_random_length() : 0;
+       if (b == 0)
+           b = 1;
+       u128 na = native(a), nb = native(b);
+       int shift = static_cast<int>(rng.next() % 128);
+       __int128 sa = static_cast<__int128>(na), sb = static_cast<__int128>(nb);
+       SF fa(a), fb(b);
+       bool ok = native(a + b) == na + nb && native(a - b) == na - nb &&
+                 native(a * b) == na * nb && native(a / b) == na / nb &&
+                 native(a % b) == na % nb &&
+                 native(a << shift) == na << shift &&
+                 native(a >> shift) == na >> shift &&
+                 native(F(fa >> shift)) == static_cast<u128>(sa >> shift) &&
+                 (a < b) == (na < nb) && (fa < fb) == (sa < sb);
+       if (ok && sb != 0 && !(sb == -1 && sa == std::numeric_limits<__int128>::min())) {
+           ok = native(F(fa / fb)) == static_cast<u128>(sa / sb) &&
+                native(F(fa % fb)) == static_cast<u128>(sa % sb);
+       }
+       if (!ok) {
+           std::cout << "fixed width test failed: a == " << a << ", b == "
+                     << b << ", shift == " << shift << "\n";
+           return 1;
+       }
+   }
+
+   // 256 bit division, on operands built from the limb values that lead to
+   // the rare corrections of Algorithm D
+   using F4 = fixed_uint<4>;
+   const uint64_t limbs[] = { 0, 1, 0x7fffffffffffffffu, 0x8000000000000000u,
+                              0xfffffffffffffffeu, 0xffffffffffffffffu };
+   std::vector<F4> values;
+   for (int i = 0; i < 6*6*6*6; ++i) {
+       F4 v;
+       for (int j = 0, k = i; j < 4; ++j, k /= 6)
+           v.limb[j] = limbs[k % 6];
+       values.push_back(v);
+   }
+   for (const F4& u : values) {
+       for (const F4& v : values) {
+           if (v == 0)
+               continue;
+           F4 q = u / v, r = u % v;
+           if (!(r < v) || q*v + r != u) {
+               std::cout << "fixed width test failed: " << u << " / " << v << "\n";
+               return 1;
+           }
+       }
+   }
+   std::cout << "Passed fixed width integer tests.\n";
+   return 0;
+}
+
+
+// Compares an engine for odd moduli, given as extended() and inverse() (as
+// safegcd_extended_euclidean() and safegcd_inverse()), with the plain loop,
+// given as reference().
+template <class S, class U, class Extended, class Inverse, class Reference>
+int test_odd_modulus(U a, U b, Extended extended, Inverse inverse, Reference reference)
+{
+   U gcd, gcd2;
+   S x, y, x2, y2;
+   extended(a, b, &gcd, &x, &y);
+   reference(a, b, &gcd2, &x2, &y2);
+   U inv = inverse(a, b);
+   U expected = (gcd2 != 1) ? U(0) : (x2 < 0) ? static_cast<U>(static_cast<U>(x2) + b)
+                                            : static_cast<U>(x2);
+   if (gcd != gcd2 || x != x2 || y != y2 || inv != expected) {
+       std::cout << "odd modulus test failed: a == " << hex_string(a)
+                 << ", b == " << hex_string(b) << "\n";
+       return 1;
+   }
+   return 0;
+}
+
+// random pairs of every length, with b made odd, and the same pairs scaled by
+// a common odd factor; then, up to 64 bits, the adversarial pairs with b odd
+// (at 128 and 256 bits there are too many of them for the plain loop)
+template <class S, class U, class Random, class Extended, class Inverse, class Reference>
+int odd_modulus_width_tests(int count, Random random, Extended extended,
+                            Inverse inverse, Reference reference)
+{
+   for (int i = 0; i < count; ++i) {
+       U a = random(), b = static_cast<U>(random() | 1u);
+       if (0 != test_odd_modulus<S>(a, b, extended, inverse, reference))
+           return 1;
+       U k = static_cast<U>(random() | 1u);
+       U ka = static_cast<U>(k * (a >> (std::numeric_limits<U>::digits / 2)));
+       U kb = static_cast<U>(k * (b >> (std::numeric_limits<U>::digits / 2)) | k);
+       if (0 != test_odd_modulus<S>(ka, kb, extended, inverse, reference))
+           return 1;
+   }
+   if constexpr (std::numeric_limits<U>::digits <= 64) {
+       adversarial_pairs<U> pairs;
+       U a, b;
+       while (pairs.next(&a, &b)) {
+           if ((b & 1u) == 1u && 0 != test_odd_modulus<S>(a, b, extended, inverse, reference))
+               return 1;
+       }
+   }
+   return 0;
+}
+
+// all pairs of uint8_t values with b odd, then 16 to 256 bits at random
+template <class Extended, class Inverse>
+int odd_modulus_tests(Extended extended, Inverse inverse, uint64_t seed)
+{
+   auto plain = [](auto a, auto b, auto* pGcd, auto* pX, auto* pY) {
+         unsigned_extended_euclidean(a, b, pGcd, pX, pY);
+      };
+   for (int a = 0; a < 256; ++a) {
+       for (int b = 1; b < 256; b += 2)
+           if (0 != test_odd_modulus<int8_t>(static_cast<uint8_t>(a), static_cast<uint8_t>(b),
+                                             extended, inverse, plain))
+               return 1;
+   }
+   xoshiro256ss rng(seed);
+   auto random16 = [&]() { return static_cast<uint16_t>(rng.next_random_length(16)); };
+   auto random32 = [&]() { return static_cast<uint32_t>(rng.next_random_length(32)); };
+   auto random64 = [&]() { return rng.next_random_length(64); };
+   using u128 = unsigned __int128;
+   auto random128 = [&]() {
+         u128 hi = rng.next_random_length(64);
+         return (rng.next() & 1) ? (hi << 64) | rng.next() : hi;
+      };
+   using F4 = fixed_uint<4>;
+   auto random256 = [&]() {
+         F4 v;
+         int top = static_cast<int>(rng.next() % 4);
+         for (int j = 0; j < top; ++j)
+             v.limb[j] = rng.next();
+         v.limb[top] = rng.next_random_length();
+         return v;
+      };
+   if (odd_modulus_width_tests<int16_t, uint16_t>(20000, random16, extended, inverse, plain) != 0 ||
+           odd_modulus_width_tests<int32_t, uint32_t>(20000, random32, extended, inverse, plain) != 0 ||
+           odd_modulus_width_tests<int64_t, uint64_t>(20000, random64, extended, inverse, plain) != 0 ||
+           odd_modulus_width_tests<__int128, u128>(20000, random128, extended, inverse, plain) != 0 ||
+           odd_modulus_width_tests<fixed_int<4>, F4>(2000, random256, extended, inverse,
+                                                     fixed_width_extended_euclidean<4>) != 0)
+       return 1;
+   return 0;
+}
+
+
+int safegcd_tests()
+{
+   auto extended = [](auto a, auto b, auto* pGcd, auto* pX, auto* pY) {
+         safegcd_extended_euclidean(a, b, pGcd, pX, pY);
+      };
+   auto inverse = [](auto a, auto m) { return safegcd_inverse(a, m); };
+   if (odd_modulus_tests(extended, inverse, 29) != 0)
+       return 1;
+   std::cout << "Passed safegcd tests.\n";
+   return 0;
+}
+
+int optimized_binary_tests()
+{
+   auto extended = [](auto a, auto b, auto* pGcd, auto* pX, auto* pY) {
+         optimized_binary_extended_euclidean(a, b, pGcd, pX, pY);
+      };
+   auto inverse = [](auto a, auto m) { return optimized_binary_inverse(a, m); };
+   if (odd_modulus_tests(extended, inverse, 31) != 0)
+       return 1;
+   std::cout << "Passed optimized binary GCD tests.\n";
+   return 0;
+}
+#endif
+
+
+#ifdef __SIZEOF_INT128__
+// v as a fixed_uint<4>, for U of up to 128 bits
+template <class U>
+fixed_uint<4> to_fixed4(U v)
+{
+   fixed_uint<4> r;
+   r.limb[0] = static_cast<uint64_t>(v);
+   if constexpr (std::numeric_limits<U>::digits > 64)
+       r.limb[1] = static_cast<uint64_t>(v >> 64);
+   return r;
+}
+
+// Checks montgomery_context<U>(m) against 256-bit arithmetic, with a and b
+// reduced modulo m.
+template <class U>
+int test_montgomery(U m, U a, U b)
+{
+   using F4 = fixed_uint<4>;
+   constexpr int N = std::numeric_limits<U>::digits;
+   montgomery_context<U> context(m);
+   a = static_cast<U>(a % m);
+   b = static_cast<U>(b % m);
+   F4 fm = to_fixed4(m);
+   F4 r = (F4(1) << N) % fm;
+   F4 r2 = (r * r) % fm;   // R^2 itself doesn't fit at N == 128
+   U aR = context.to_montgomery(a), bR = context.to_montgomery(b);
+   U product = context.from_montgomery(context.multiply(aR, bR));
+   if (static_cast<U>(m * context.negated_inverse()) != std::numeric_limits<U>::max() ||
+           to_fixed4(context.r_squared()) != r2 ||
+           to_fixed4(aR) != ((to_fixed4(a) << N) % fm) ||
+           to_fixed4(product) != (to_fixed4(a) * to_fixed4(b)) % fm ||
+           context.from_montgomery(aR) != a) {
+       std::cout << "montgomery test failed: m == " << hex_string(m) << ", a == "
+                 << hex_string(a) << ", b == " << hex_string(b) << "\n";
+       return 1;
+   }
+   return 0;
+}
+#endif
+
+// inverse_mod_word() for every odd d of 8 and 16 bits, against the
+// coefficient x of unsigned_extended_euclidean(d, 2^k) at twice the width,
+// and at 32 to 128 bits for random d; then, with __int128 for the fixed_uint
+// reference, montgomery_context for every odd 16-bit modulus, and for random
+// ones up to 128 bits
+int montgomery_tests()
+{
+   for (uint32_t d = 1; d < 65536; d += 2) {
+       uint32_t gcd;
+       int32_t x, y;
+       unsigned_extended_euclidean(d, uint32_t(1) << 16, &gcd, &x, &y);
+       uint16_t inverse16 = inverse_mod_word(static_cast<uint16_t>(d));
+       if (gcd != 1 || inverse16 != static_cast<uint16_t>(x)) {
+           std::cout << "inverse_mod_word test failed: d == " << d << "\n";
+           return 1;
+       }
+       if (d < 256) {
+           unsigned_extended_euclidean(d, uint32_t(1) << 8, &gcd, &x, &y);
+           if (inverse_mod_word(static_cast<uint8_t>(d)) != static_cast<uint8_t>(x)) {
+               std::cout << "inverse_mod_word test failed: d == " << d << "\n";
+               return 1;
+           }
+       }
+   }
+   xoshiro256ss rng(37);
+   for (int i = 0; i < 100000; ++i) {
+       uint64_t d = rng.next() | 1u;
+       bool failed = static_cast<uint32_t>(static_cast<uint32_t>(d) *
+                                           inverse_mod_word(static_cast<uint32_t>(d))) != 1u ||
+                     d * inverse_mod_word(d) != 1u;
+#ifdef __SIZEOF_INT128__
+       using u128 = unsigned __int128;
+       u128 d128 = (static_cast<u128>(rng.next()) << 64) | d;
+       failed = failed || d128 * inverse_mod_word(d128) != 1u;
+#endif
+       if (failed) {
+           std::cout << "inverse_mod_word test failed: d == " << d << "\n";
+           return 1;
+       }
+   }
+
+#ifdef __SIZEOF_INT128__
+   using u128 = unsigned __int128;
+   for (uint32_t m = 1; m < 65536; m += 2) {
+       if (m < 256 && 0 != test_montgomery<uint8_t>(static_cast<uint8_t>(m),
+                                                    static_cast<uint8_t>(rng.next()),
+                                                    static_cast<uint8_t>(rng.next())))
+           return 1;
+       if (0 != test_montgomery<uint16_t>(static_cast<uint16_t>(m),
+                                          static_cast<uint16_t>(rng.next()),
+                                          static_cast<uint16_t>(m - 1)))
+           return 1;
+   }
+   for (int i = 0; i < 20000; ++i) {
+       auto random128 = [&]() {
+             u128 hi = rng.next_random_length(64);
+             return (rng.next() & 1) ? (hi << 64) | rng.next() : hi;
+          };
+       uint64_t m64 = rng.next_random_length(64) | 1u;
+       u128 m128 = random128() | 1u;
+       if (0 != test_montgomery<uint32_t>(static_cast<uint32_t>(m64), static_cast<uint32_t>(rng.next()),
+                                          static_cast<uint32_t>(rng.next())) ||
+               0 != test_montgomery<uint64_t>(m64, rng.next(), rng.next()) ||
+               0 != test_montgomery<uint64_t>(m64 | (uint64_t(1) << 63), rng.next(), ~uint64_t(0)) ||
+               0 != test_montgomery<u128>(m128, random128(), random128()))
+           return 1;
+   }
+#endif
+
+   std::cout << "Passed Montgomery context tests.\n";
+   return 0;
+}
+
+
+// (a|n) for odd n, from its definition: the product over the prime factors p
+// of n of the Legendre symbol (a|p), by Euler's criterion a^((p-1)/2) mod p
+int reference_jacobi(uint64_t a, uint32_t n)
+{
+   auto power_mod = [](uint64_t b, uint32_t e, uint32_t p) {
+         uint64_t r = 1 % p;
+         for (b %= p; e != 0; e >>= 1, b = b*b % p)
+             if (e & 1)
+                 r = r*b % p;
+         return r;
+      };
+   int symbol = 1;
+   for (uint32_t p = 3; n > 1; p += 2) {
+       if (static_cast<uint64_t>(p)*p > n)
+           p = n;   // what remains is prime
+       for (; n % p == 0; n /= p) {
+           uint64_t e = power_mod(a, (p - 1)/2, p);
+           symbol *= (e == 0) ? 0 : (e == 1) ? 1 : -1;
+       }
+   }
+   return symbol;
+}
+
+// (a|n) for any n, from the definition of the Kronecker symbol
+int reference_kronecker(int64_t a, int64_t n)
+{
+   if (n == 0)
+       return (a == 1 || a == -1) ? 1 : 0;
+   int symbol = 1;
+   if (n < 0) {
+       n = -n;
+       if (a < 0)
+           symbol = -1;
+   }
+   for (; n % 2 == 0; n /= 2) {
+       int64_t r = ((a % 8) + 8) % 8;
+       symbol *= (r % 2 == 0) ? 0 : (r == 1 || r == 7) ? 1 : -1;
+   }
+   int64_t r = ((a % n) + n) % n;
+   return symbol * reference_jacobi(static_cast<uint64_t>(r), static_cast<uint32_t>(n));
+}
+
+// Compares jacobi_symbol(), binary_jacobi_symbol() and
+// extended_euclidean_jacobi() with each other and with expected (unless it's
+// 2), and the gcd and inverse with unsigned_extended_euclidean().
+template <class S, class U>
+int test_jacobi(U a, U n, int expected)
+{
+   U gcd, gcd2, inverse;
+   S x, y;
+   int symbol;
+   extended_euclidean_jacobi<S>(a, n, &gcd, &inverse, &symbol);
+   unsigned_extended_euclidean(a, n, &gcd2, &x, &y);
+   U expectedInverse = (gcd2 != 1 || n == 1) ? U(0) : (x < 0) ? static_cast<U>(static_cast<U>(x) + n)
+                                                             : static_cast<U>(x);
+   int euclidean = jacobi_symbol(a, n);
+   if (expected == 2)
+       expected = euclidean;
+   if (euclidean != expected || binary_jacobi_symbol(a, n) != expected ||
+           symbol != expected || gcd != gcd2 || inverse != expectedInverse) {
+       std::cout << "jacobi test failed: a == " << hex_string(a)
+                 << ", n == " << hex_string(n) << "\n";
+       return 1;
+   }
+   return 0;
+}
+
+int jacobi_tests()
+{
+   // every a and odd n of 8 bits, and every odd n below 2^16 with a few a,
+   // against the definition
+   for (uint32_t n = 1; n < 65536; n += 2) {
+       for (uint32_t a = 0; a < 256 && n < 256; ++a)
+           if (0 != test_jacobi<int8_t>(static_cast<uint8_t>(a), static_cast<uint8_t>(n),
+                                        reference_jacobi(a, n)))
+               return 1;
+       for (uint32_t a : { 0u, 1u, 2u, n - 1, n / 2, (n * 40503u) & 0xffffu })
+           if (0 != test_jacobi<int16_t>(static_cast<uint16_t>(a), static_cast<uint16_t>(n),
+                                         reference_jacobi(a, n)))
+               return 1;
+   }
+   // the variants against each other at 32 to 128 bits (64 without
+   // __int128), with random pairs of every length and scaled ones, so that
+   // the gcd is often above 1
+   xoshiro256ss rng(41);
+   for (int i = 0; i < 50000; ++i) {
+       uint64_t a = rng.next_random_length(64), n = rng.next_random_length(64) | 1u;
+       uint64_t k = rng.next_random_length(16) | 1u;
+       if (0 != test_jacobi<int32_t>(static_cast<uint32_t>(a), static_cast<uint32_t>(n), 2) ||
+               0 != test_jacobi<int64_t>(a, n, 2) ||
+               0 != test_jacobi<int64_t>(k * (a >> 20), k * ((n >> 20) | 1u), 2))
+           return 1;
+#ifdef __SIZEOF_INT128__
+       using u128 = unsigned __int128;
+       u128 a128 = (static_cast<u128>(rng.next_random_length(64)) << 64) | rng.next();
+       u128 n128 = (static_cast<u128>(rng.next_random_length(64)) << 64) | rng.next() | 1u;
+       if (0 != test_jacobi<__int128>(a128, n128, 2))
+           return 1;
+#endif
+   }
+   // kronecker_symbol() for every pair of int8_t and of uint8_t values
+   for (int a = -128; a < 128; ++a) {
+       for (int n = -128; n < 128; ++n) {
+           int expected = reference_kronecker(a, n);
+           bool unsignedFails = (a >= 0 && n >= 0 &&
+                   kronecker_symbol(static_cast<uint8_t>(a), static_cast<uint8_t>(n)) != expected) ||
+                   kronecker_symbol(static_cast<uint8_t>(a + 128), static_cast<uint8_t>(n + 128)) !=
+                       reference_kronecker(a + 128, n + 128);
+           if (kronecker_symbol(static_cast<int8_t>(a), static_cast<int8_t>(n)) != expected ||
+                   unsignedFails) {
+               std::cout << "kronecker test failed: a == " << a << ", n == " << n << "\n";
+               return 1;
+           }
+       }
+   }
+   std::cout << "Passed Jacobi symbol tests.\n";
+   return 0;
+}
+
+
+// Runs continued_fraction(a, b) to the end, and checks that each convergent
+// p/h has abs(a*h - b*p) == the remainder after its quotient and
+// p*h' - p'*h == +-1 with the one before it, that the last is a/b in lowest
+// terms, and that the second-to-last is abs(x), abs(y) of
+// unsigned_extended_euclidean(); U is of at most 64 bits (16 without
+// __int128).
+template <class S, class U>
+int test_continued_fraction(U a, U b)
+{
+#ifdef __SIZEOF_INT128__
+   using W = __int128;
+#else
+   using W = int64_t;
+   static_assert(std::numeric_limits<U>::digits <= 16, "");
+#endif
+   U gcd;
+   S x, y;
+   unsigned_extended_euclidean(a, b, &gcd, &x, &y);
+   continued_fraction<U> cf(a, b);
+   U q, p, h;
+   U pPrev = 1, hPrev = 0, r0 = a, r1 = b;
+   bool failed = false;
+   while (cf.next(&q, &p, &h)) {
+       U r2 = static_cast<U>(r0 - q*r1);
+       W error = static_cast<W>(a)*h - static_cast<W>(b)*p;
+       W determinant = static_cast<W>(p)*hPrev - static_cast<W>(pPrev)*h;
+       if (q != r0/r1 || (error != r2 && error != -static_cast<W>(r2)) ||
+               (determinant != 1 && determinant != -1))
+           failed = true;
+       if (r2 == 0) {
+           if (p != a/gcd || h != b/gcd || unsigned_magnitude(x) != hPrev ||
+                   unsigned_magnitude(y) != pPrev)
+               failed = true;
+       }
+       r0 = r1;
+       r1 = r2;
+       pPrev = p;
+       hPrev = h;
+   }
+   if (failed || r1 != 0 || (b == 0 && hPrev != 0)) {
+       std::cout << "continued fraction test failed: a == " << hex_string(a)
+                 << ", b == " << hex_string(b) << "\n";
+       return 1;
+   }
+   return 0;
+}
+
+// Compares best_rational_approximation(a, b, maxDenominator) with a search
+// of every denominator; U is of at most 64 bits (16 without __int128), and
+// maxDenominator small.
+template <class U>
+int test_best_rational_approximation(U a, U b, U maxDenominator)
+{
+#ifdef __SIZEOF_INT128__
+   using W = unsigned __int128;
+#else
+   using W = uint64_t;
+   static_assert(std::numeric_limits<U>::digits <= 16, "");
+#endif
+   U p, h;
+   best_rational_approximation(a, b, maxDenominator, &p, &h);
+   // the closest p/h for each h is floor(a*h/b) or the next numerator, and
+   // p1/h1 is closer than p2/h2 if abs(a*h1 - b*p1)*h2 < abs(a*h2 - b*p2)*h1
+   auto distance = [&](W pp, W hh) {
+         W ah = static_cast<W>(a)*hh, bp = static_cast<W>(b)*pp;
+         return (ah > bp) ? ah - bp : bp - ah;
+      };
+   W bestP = 0, bestH = 1, bestDistance = distance(0, 1);
+   for (W hh = 1; hh <= maxDenominator; ++hh) {
+       W floorP = static_cast<W>(a)*hh / b;
+       for (W pp : { floorP, floorP + 1 }) {
+           W d = distance(pp, hh);
+           if (d*bestH < bestDistance*hh) {
+               bestP = pp;
+               bestH = hh;
+               bestDistance = d;
+           }
+       }
+   }
+   if (p != bestP || h != bestH) {
+       std::cout << "best rational approximation test failed: a == " << hex_string(a)
+                 << ", b == " << hex_string(b) << ", maxDenominator == "
+                 << hex_string(maxDenominator) << "\n";
+       return 1;
+   }
+   return 0;
+}
+
+int continued_fraction_tests()
+{
+   // the generator for every pair of uint8_t values, and the best
+   // approximations for every a, b and maxDenominator below 64
+   for (int a = 0; a < 256; ++a) {
+       for (int b = 0; b < 256; ++b) {
+           if (0 != test_continued_fraction<int8_t>(static_cast<uint8_t>(a), static_cast<uint8_t>(b)))
+               return 1;
+           for (int d = 1; a < 64 && b != 0 && b < 64 && d < 64; ++d)
+               if (0 != test_best_rational_approximation<uint8_t>(static_cast<uint8_t>(a),
+                               static_cast<uint8_t>(b), static_cast<uint8_t>(d)))
+                   return 1;
+       }
+   }
+   // random and adversarial pairs at 16 to 64 bits (16 without __int128),
+   // with maxDenominator below 2^12 for the search
+   xoshiro256ss rng(43);
+   for (int i = 0; i < 20000; ++i) {
+       uint64_t a = rng.next_random_length(64), b = rng.next_random_length(64);
+       if (0 != test_continued_fraction<int16_t>(static_cast<uint16_t>(a), static_cast<uint16_t>(b)))
+           return 1;
+#ifdef __SIZEOF_INT128__
+       if (0 != test_continued_fraction<int32_t>(static_cast<uint32_t>(a), static_cast<uint32_t>(b)) ||
+               0 != test_continued_fraction<int64_t>(a, b))
+           return 1;
+#endif
+       if (i < 2000) {
+           uint64_t d = (rng.next() & 0xfff) | 1u;
+           if (0 != test_best_rational_approximation<uint16_t>(static_cast<uint16_t>(a),
+                            static_cast<uint16_t>(b | 1u), static_cast<uint16_t>(d)))
+               return 1;
+#ifdef __SIZEOF_INT128__
+           if (0 != test_best_rational_approximation<uint64_t>(a, b | 1u, d))
+               return 1;
+#endif
+       }
+   }
+#ifdef __SIZEOF_INT128__
+   adversarial_pairs<uint64_t> pairs;
+   uint64_t a, b;
+   while (pairs.next(&a, &b)) {
+       if (0 != test_continued_fraction<int64_t>(a, b))
+           return 1;
+   }
+#endif
+   std::cout << "Passed continued fraction tests.\n";
+   return 0;
+}
+
 
 int main(int argc, char *argv[])
 {
@@ -169,6 +1321,34 @@ int main(int argc, char *argv[])
        return 1;
    if (extreme_values_tests() != 0)
        return 1;
+   if (adversarial_tests() != 0)
+       return 1;
+   if (interleaved_tests() != 0)
+       return 1;
+   if (parallel_tests() != 0)
+       return 1;
+   if (dispatch_tests() != 0)
+       return 1;
+   if (scalar_engine_tests() != 0)
+       return 1;
+   if (autotune_tests() != 0)
+       return 1;
+   if (signed_input_tests() != 0)
+       return 1;
+#ifdef __SIZEOF_INT128__
+   if (fixed_width_tests() != 0)
+       return 1;
+   if (safegcd_tests() != 0)
+       return 1;
+   if (optimized_binary_tests() != 0)
+       return 1;
+#endif
+   if (montgomery_tests() != 0)
+       return 1;
+   if (jacobi_tests() != 0)
+       return 1;
+   if (continued_fraction_tests() != 0)
+       return 1;
 
    std::cout << "\n*** Passed all tests ***\n";
    return 0;
@@ -0,0 +1,436 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Compares two result files written by a benchmark's --json option (see
+// benchmark/bench_json.h): a baseline and a candidate.  Results are matched
+// by engine, type and distribution, and for each match the per-run ns per
+// call samples are compared with Welch's t-test, which doesn't assume equal
+// variances.  The report gives both means, the change with its 95%
+// confidence interval, and the p-value.
+//
+// A match is a regression if the candidate is slower with p < --alpha and by
+// more than --threshold percent; a significant but smaller slowdown is only
+// noted, since run-to-run noise in the mean is typically a percent or two.
+// The exit status is 1 if any match regressed (2 on bad input), so the tool
+// can gate a CI job.  Compare files from the same host: if the host
+// fingerprints differ a warning is printed, since the comparison then
+// measures the machines as much as the code.
+//
+// Usage: bench_compare BASELINE.json CANDIDATE.json [--alpha P]
+//                      [--threshold PERCENT]
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+// ---- a minimal JSON reader, enough for the files of bench_json.h ----
+
+struct json_value {
+   enum kind_t { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT } kind = NUL;
+   bool boolean = false;
+   double number = 0;
+   std::string string;
+   std::vector<json_value> array;
+   std::map<std::string, json_value> object;
+
+   // the member 'key' of an object, or a null value
+   const json_value& operator[](const char* key) const
+   {
+      static const json_value none;
+      auto it = object.find(key);
+      return (kind == OBJECT && it != object.end()) ? it->second : none;
+   }
+};
+
+
+class json_parser {
+   const char* p;
+   const char* end;
+
+   void skip_space()
+   {
+      while (p < end && std::isspace(static_cast<unsigned char>(*p)))
+         ++p;
+   }
+
+   bool expect(char c)
+   {
+      skip_space();
+      if (p < end && *p == c) {
+         ++p;
+         return true;
+      }
+      return false;
+   }
+
+   bool parse_literal(const char* word)
+   {
+      std::size_t len = std::strlen(word);
+      if (static_cast<std::size_t>(end - p) < len || std::strncmp(p, word, len) != 0)
+         return false;
+      p += len;
+      return true;
+   }
+
+   // only \uXXXX escapes below 0x80 are decoded, as bench_json.h writes
+   bool parse_string(std::string* out)
+   {
+      if (!expect('"'))
+         return false;
+      while (p < end && *p != '"') {
+         char c = *p++;
+         if (c != '\\') {
+            *out += c;
+            continue;
+         }
+         if (p >= end)
+            return false;
+         c = *p++;
+         switch (c) {
+            case 'n': *out += '\n'; break;
+            case 't': *out += '\t'; break;
+            case 'r': *out += '\r'; break;
+            case 'b': *out += '\b'; break;
+            case 'f': *out += '\f'; break;
+            case 'u': {
+               if (end - p < 4)
+                  return false;
+               unsigned long code = std::strtoul(std::string(p, 4).c_str(), nullptr, 16);
+               *out += static_cast<char>(code < 0x80 ? code : '?');
+               p += 4;
+               break;
+            }
+            default: *out += c; break;
+         }
+      }
+      return expect('"');
+   }
+
+   bool parse_value(json_value* v, int depth)
+   {
+      skip_space();
+      if (p >= end || depth > 64)
+         return false;
+      if (*p == '{') {
+         ++p;
+         v->kind = json_value::OBJECT;
+         if (expect('}'))
+            return true;
+         do {
+            std::string key;
+            skip_space();
+            if (!parse_string(&key) || !expect(':') ||
+                    !parse_value(&v->object[key], depth + 1))
+               return false;
+         } while (expect(','));
+         return expect('}');
+      }
+      if (*p == '[') {
+         ++p;
+         v->kind = json_value::ARRAY;
+         if (expect(']'))
+            return true;
+         do {
+            v->array.emplace_back();
+            if (!parse_value(&v->array.back(), depth + 1))
+               return false;
+         } while (expect(','));
+         return expect(']');
+      }
+      if (*p == '"') {
+         v->kind = json_value::STRING;
+         return parse_string(&v->string);
+      }
+      if (parse_literal("true")) {
+         v->kind = json_value::BOOLEAN;
+         v->boolean = true;
+         return true;
+      }
+      if (parse_literal("false")) {
+         v->kind = json_value::BOOLEAN;
+         return true;
+      }
+      if (parse_literal("null"))
+         return true;
+      char* numberEnd;
+      std::string rest(p, std::min<std::size_t>(end - p, 64));
+      v->number = std::strtod(rest.c_str(), &numberEnd);
+      if (numberEnd == rest.c_str())
+         return false;
+      v->kind = json_value::NUMBER;
+      p += numberEnd - rest.c_str();
+      return true;
+   }
+
+public:
+   // returns false on a syntax error
+   bool parse(const std::string& text, json_value* v)
+   {
+      p = text.data();
+      end = p + text.size();
+      if (!parse_value(v, 0))
+         return false;
+      skip_space();
+      return p == end;
+   }
+};
+
+
+bool read_json_file(const char* path, json_value* v)
+{
+   std::FILE* file = std::fopen(path, "rb");
+   if (file == nullptr) {
+      std::cout << "cannot open " << path << "\n";
+      return false;
+   }
+   std::string text;
+   char buffer[65536];
+   std::size_t got;
+   while ((got = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+      text.append(buffer, got);
+   std::fclose(file);
+   if (!json_parser().parse(text, v) || (*v)["schema"].number != 1) {
+      std::cout << path << " is not a benchmark --json result file\n";
+      return false;
+   }
+   return true;
+}
+
+
+// ---- Welch's t-test ----
+
+// The regularized incomplete beta function I_x(a, b), by the continued
+// fraction of Numerical Recipes (betacf), with the symmetry
+// I_x(a, b) = 1 - I_{1-x}(b, a) for fast convergence.
+double incomplete_beta(double a, double b, double x)
+{
+   if (x <= 0)
+      return 0;
+   if (x >= 1)
+      return 1;
+   if (x > (a + 1) / (a + b + 2))
+      return 1 - incomplete_beta(b, a, 1 - x);
+   const double tiny = 1e-300;
+   double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) +
+                           a * std::log(x) + b * std::log1p(-x)) / a;
+   double c = 1, d = 1 - (a + b) * x / (a + 1);
+   if (std::fabs(d) < tiny)
+      d = tiny;
+   d = 1 / d;
+   double f = d;
+   for (int m = 1; m <= 300; ++m) {
+      for (int step = 0; step < 2; ++step) {
+         double numerator = (step == 0)
+               ? m * (b - m) * x / ((a + 2*m - 1) * (a + 2*m))
+               : -(a + m) * (a + b + m) * x / ((a + 2*m) * (a + 2*m + 1));
+         d = 1 + numerator * d;
+         if (std::fabs(d) < tiny)
+            d = tiny;
+         c = 1 + numerator / c;
+         if (std::fabs(c) < tiny)
+            c = tiny;
+         d = 1 / d;
+         f *= c * d;
+      }
+      if (std::fabs(c * d - 1) < 1e-12)
+         break;
+   }
+   return front * f;
+}
+
+// P(|T| > |t|) for Student's t with df degrees of freedom
+double t_two_sided_p(double t, double df)
+{
+   return incomplete_beta(df / 2, 0.5, df / (df + t * t));
+}
+
+// the t with P(|T| > t) = p, by bisection
+double t_critical(double p, double df)
+{
+   double lo = 0, hi = 1e3;
+   for (int i = 0; i < 200; ++i) {
+      double mid = (lo + hi) / 2;
+      if (t_two_sided_p(mid, df) > p)
+         lo = mid;
+      else
+         hi = mid;
+   }
+   return (lo + hi) / 2;
+}
+
+
+struct sample_stats {
+   std::size_t n = 0;
+   double mean = 0, variance = 0;
+};
+
+sample_stats describe(const json_value& samples)
+{
+   sample_stats s;
+   for (const json_value& v : samples.array) {
+      ++s.n;
+      double delta = v.number - s.mean;     // Welford
+      s.mean += delta / s.n;
+      s.variance += delta * (v.number - s.mean);
+   }
+   s.variance = (s.n > 1) ? s.variance / (s.n - 1) : 0;
+   return s;
+}
+
+
+struct welch_result {
+   double difference;   // candidate mean - baseline mean
+   double halfWidth;    // of the confidence interval of the difference
+   double p;
+};
+
+welch_result welch_test(const sample_stats& base, const sample_stats& cand,
+                        double confidence)
+{
+   welch_result r;
+   r.difference = cand.mean - base.mean;
+   double vb = base.variance / base.n, vc = cand.variance / cand.n;
+   double se = std::sqrt(vb + vc);
+   if (se == 0 || base.n < 2 || cand.n < 2) {
+      r.halfWidth = 0;
+      r.p = (r.difference == 0 || base.n < 2 || cand.n < 2) ? 1 : 0;
+      return r;
+   }
+   // the Welch-Satterthwaite degrees of freedom
+   double df = (vb + vc) * (vb + vc) /
+               (vb * vb / (base.n - 1) + vc * vc / (cand.n - 1));
+   r.p = t_two_sided_p(r.difference / se, df);
+   r.halfWidth = t_critical(1 - confidence, df) * se;
+   return r;
+}
+
+
+// ---- the comparison ----
+
+void compare_hosts(const json_value& base, const json_value& cand)
+{
+   static const char* const keys[] = { "cpu", "vendor", "family", "model",
+                                       "avx2", "avx512f", "os", "compiler" };
+   for (const char* key : keys) {
+      const json_value& b = base[key];
+      const json_value& c = cand[key];
+      bool same = b.kind == c.kind && b.string == c.string &&
+                  b.number == c.number && b.boolean == c.boolean;
+      if (!same)
+         std::cout << "warning: the files come from different hosts or builds "
+                      "(\"" << key << "\" differs)\n";
+   }
+}
+
+
+std::string result_key(const json_value& r)
+{
+   return r["engine"].string + " " + r["type"].string + " " +
+          r["distribution"].string;
+}
+
+
+int main(int argc, char *argv[])
+{
+   const char* paths[2] = { nullptr, nullptr };
+   int numPaths = 0;
+   double alpha = 0.05;
+   double threshold = 2.0;
+   for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--alpha") == 0 && i + 1 < argc) {
+         alpha = std::atof(argv[++i]);
+      } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+         threshold = std::atof(argv[++i]);
+      } else if (argv[i][0] != '-' && numPaths < 2) {
+         paths[numPaths++] = argv[i];
+      } else {
+         std::cout << "unknown or incomplete option: " << argv[i] << "\n";
+         return 2;
+      }
+   }
+   if (numPaths != 2) {
+      std::cout << "usage: bench_compare BASELINE.json CANDIDATE.json "
+                   "[--alpha P] [--threshold PERCENT]\n";
+      return 2;
+   }
+
+   json_value base, cand;
+   if (!read_json_file(paths[0], &base) || !read_json_file(paths[1], &cand))
+      return 2;
+   compare_hosts(base["host"], cand["host"]);
+
+   std::map<std::string, const json_value*> baseResults;
+   for (const json_value& r : base["results"].array)
+      baseResults[result_key(r)] = &r;
+
+   // wide enough for every engine name, as the benchmarks name them freely
+   int engineWidth = 14;
+   for (const json_value& r : cand["results"].array)
+      engineWidth = std::max(engineWidth, static_cast<int>(r["engine"].string.size()) + 1);
+
+   std::cout << std::left << std::setw(engineWidth) << "engine" << std::setw(10) << "type"
+             << std::setw(15) << "dist" << std::right << std::setw(10) << "base ns"
+             << std::setw(10) << "cand ns" << std::setw(9) << "change"
+             << std::setw(18) << "95% CI" << std::setw(10) << "p" << "\n";
+   int regressions = 0, improvements = 0, matched = 0;
+   for (const json_value& r : cand["results"].array) {
+      auto it = baseResults.find(result_key(r));
+      if (it == baseResults.end()) {
+         std::cout << "(" << result_key(r) << ": not in the baseline)\n";
+         continue;
+      }
+      const json_value& b = *it->second;
+      baseResults.erase(it);
+      ++matched;
+      sample_stats sb = describe(b["ns_per_call"]);
+      sample_stats sc = describe(r["ns_per_call"]);
+      if (sb.n == 0 || sc.n == 0 || sb.mean <= 0)
+         continue;
+      welch_result w = welch_test(sb, sc, 0.95);
+      double change = 100 * w.difference / sb.mean;
+      double ciLow = 100 * (w.difference - w.halfWidth) / sb.mean;
+      double ciHigh = 100 * (w.difference + w.halfWidth) / sb.mean;
+      char ci[32], p[16];
+      std::snprintf(ci, sizeof(ci), "[%+.1f%%, %+.1f%%]", ciLow, ciHigh);
+      std::snprintf(p, sizeof(p), "%.3g", w.p);
+
+      const char* verdict = "";
+      if (w.p < alpha && change > threshold) {
+         verdict = "  REGRESSION";
+         ++regressions;
+      } else if (w.p < alpha && change > 0) {
+         verdict = "  slower (below threshold)";
+      } else if (w.p < alpha && change < -threshold) {
+         verdict = "  faster";
+         ++improvements;
+      }
+      std::cout << std::left << std::setw(engineWidth) << r["engine"].string
+                << std::setw(10) << r["type"].string << std::setw(15)
+                << r["distribution"].string << std::right << std::fixed
+                << std::setprecision(2) << std::setw(10) << sb.mean
+                << std::setw(10) << sc.mean << std::setprecision(1)
+                << std::showpos << std::setw(8) << change << "%" << std::noshowpos
+                << std::setw(18) << ci << std::setw(10) << p << verdict << "\n"
+                << std::defaultfloat;
+      if (sb.n < 3 || sc.n < 3)
+         std::cout << "   (fewer than 3 runs: record with --runs 5 or more "
+                      "for a meaningful test)\n";
+   }
+   for (const auto& entry : baseResults)
+      std::cout << "(" << entry.first << ": not in the candidate)\n";
+
+   std::cout << "\n" << matched << " results compared, " << regressions
+             << " regressions, " << improvements << " improvements (alpha "
+             << alpha << ", threshold " << threshold << "%)\n";
+   return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,322 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// Solves a file of packed binary (a, b) pairs with the batched engines, and
+// writes the packed results (gcd, x, y) to an output file.  Both files are
+// memory mapped: the output is preallocated at its final size, and the
+// engines read the inputs from and write the results to the mappings
+// directly, chunk by chunk on a work_stealing_pool, with no intermediate
+// copies.  The results are identical to those of
+// unsigned_extended_euclidean(a, b, ...).
+//
+// Formats, selected by --format WIDTH[:LAYOUT], in native byte order:
+//   WIDTH   8, 16, 32 or 64: a, b and gcd are uintWIDTH_t, x and y intWIDTH_t
+//   aos     input  a0 b0 a1 b1 ...,         output g0 x0 y0 g1 x1 y1 ...
+//   soa     input  a0 a1 ... b0 b1 ...,     output g0 g1 ... x0 x1 ... y0 y1 ...
+// The soa layout goes through the dispatched kernel (see
+// extended_euclidean_dispatch.h), and aos through the strided interleaved
+// engine.
+//
+// Usage:
+//   extended_euclidean_stream [--format WIDTH[:LAYOUT]] [--threads N]
+//                             [--chunk PAIRS] [--verify] INPUT OUTPUT
+//   extended_euclidean_stream --generate PAIRS [--format WIDTH[:LAYOUT]]
+//                             [--seed SEED] OUTPUT
+// The default format is 64:aos.  --generate writes an input file of random
+// pairs with uniformly distributed bit lengths.
+
+#include "../extended_euclidean_dispatch.h"
+#include "../interleaved_extended_euclidean.h"
+#include "../input_generators.h"
+#include "../unsigned_extended_euclidean.h"
+#include "../work_stealing_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+struct stream_format {
+   int width = 64;
+   bool soa = false;
+};
+
+// parses WIDTH[:LAYOUT]; returns false if the format is malformed
+bool parse_format(const char* text, stream_format* pFormat)
+{
+   char* end;
+   long width = std::strtol(text, &end, 10);
+   if (width != 8 && width != 16 && width != 32 && width != 64)
+      return false;
+   pFormat->width = static_cast<int>(width);
+   if (*end == '\0')
+      return true;
+   if (std::strcmp(end, ":aos") == 0)
+      pFormat->soa = false;
+   else if (std::strcmp(end, ":soa") == 0)
+      pFormat->soa = true;
+   else
+      return false;
+   return true;
+}
+
+
+// A file mapped into memory in its entirety; unmapped and closed on
+// destruction.  A file of size 0 has a null mapping.
+class mapped_file {
+   int fd = -1;
+   void* base = nullptr;
+   std::size_t length = 0;
+
+   bool fail(const char* what, const char* path)
+   {
+      std::cerr << what << " " << path << ": " << std::strerror(errno) << "\n";
+      return false;
+   }
+
+public:
+   mapped_file() = default;
+   mapped_file(const mapped_file&) = delete;
+   mapped_file& operator=(const mapped_file&) = delete;
+   ~mapped_file()
+   {
+      if (base != nullptr)
+         munmap(base, length);
+      if (fd >= 0)
+         close(fd);
+   }
+
+   void* data() const { return base; }
+   std::size_t size() const { return length; }
+
+   bool open_read(const char* path)
+   {
+      fd = open(path, O_RDONLY);
+      if (fd < 0)
+         return fail("cannot open", path);
+      struct stat st;
+      if (fstat(fd, &st) != 0)
+         return fail("cannot stat", path);
+      length = static_cast<std::size_t>(st.st_size);
+      if (length == 0)
+         return true;
+      base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (base == MAP_FAILED) {
+         base = nullptr;
+         return fail("cannot map", path);
+      }
+      madvise(base, length, MADV_SEQUENTIAL);
+      return true;
+   }
+
+   // creates or truncates the file, and preallocates it at 'size' bytes
+   bool create(const char* path, std::size_t size)
+   {
+      fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+      if (fd < 0)
+         return fail("cannot create", path);
+      if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+         return fail("cannot resize", path);
+      length = size;
+      if (length == 0)
+         return true;
+      base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (base == MAP_FAILED) {
+         base = nullptr;
+         return fail("cannot map", path);
+      }
+      madvise(base, length, MADV_SEQUENTIAL);
+      return true;
+   }
+};
+
+
+// Where the fields of pair i live, for either layout: a[i*inStride],
+// b[i*inStride], g[i*outStride], x[i*outStride], y[i*outStride].
+template <class S, class U>
+struct stream_layout {
+   const U* a;
+   const U* b;
+   U* g;
+   S* x;
+   S* y;
+   std::size_t inStride, outStride;
+
+   stream_layout(const void* in, void* out, std::size_t n, bool soa)
+   {
+      const U* inU = static_cast<const U*>(in);
+      U* outU = static_cast<U*>(out);
+      if (soa) {
+         a = inU;      b = inU + n;
+         g = outU;     x = reinterpret_cast<S*>(outU + n);
+         y = reinterpret_cast<S*>(outU + 2*n);
+         inStride = outStride = 1;
+      } else {
+         a = inU;      b = inU + 1;
+         g = outU;     x = reinterpret_cast<S*>(outU + 1);
+         y = reinterpret_cast<S*>(outU + 2);
+         inStride = 2; outStride = 3;
+      }
+   }
+};
+
+
+template <class U>
+int generate(const char* path, std::size_t n, uint64_t seed, bool soa)
+{
+   using S = typename std::make_signed<U>::type;
+   mapped_file file;
+   if (!file.create(path, n * 2 * sizeof(U)))
+      return 1;
+   stream_layout<S, U> layout(file.data(), file.data(), n, soa);
+   U* a = const_cast<U*>(layout.a);
+   U* b = const_cast<U*>(layout.b);
+   random_pairs<U> pairs(n, seed, true);
+   for (std::size_t i = 0; i < n; ++i)
+      pairs.next(&a[i*layout.inStride], &b[i*layout.inStride]);
+   std::cout << "wrote " << n << " pairs to " << path << "\n";
+   return 0;
+}
+
+
+template <class U>
+int stream(const char* inPath, const char* outPath, bool soa,
+           std::size_t chunk, unsigned int numThreads, bool verify)
+{
+   using S = typename std::make_signed<U>::type;
+   using clock = std::chrono::steady_clock;
+   const char* kernel = soa ? dispatched_kernel<S, U>().name
+                            : "interleaved4, strided";
+   work_stealing_pool pool(numThreads);
+
+   auto start = clock::now();
+   mapped_file in, out;
+   if (!in.open_read(inPath))
+      return 1;
+   if (in.size() % (2 * sizeof(U)) != 0) {
+      std::cerr << inPath << ": size " << in.size()
+                << " isn't a whole number of " << 2 * sizeof(U)
+                << " byte pairs\n";
+      return 1;
+   }
+   const std::size_t n = in.size() / (2 * sizeof(U));
+   if (!out.create(outPath, n * 3 * sizeof(U)))
+      return 1;
+   const stream_layout<S, U> layout(in.data(), out.data(), n, soa);
+
+   pool.parallel_for((n + chunk - 1) / chunk, [&](std::size_t c) {
+         std::size_t begin = c * chunk;
+         std::size_t count = std::min(chunk, n - begin);
+         const std::size_t i = begin * layout.inStride;
+         const std::size_t o = begin * layout.outStride;
+         if (soa) {
+            dispatched_extended_euclidean<S, U>(layout.a + i, layout.b + i,
+                     count, layout.g + o, layout.x + o, layout.y + o);
+         } else {
+            interleaved_extended_euclidean_strided<4, S, U>(layout.a + i,
+                     layout.b + i, layout.inStride, count, layout.g + o,
+                     layout.x + o, layout.y + o, layout.outStride);
+         }
+      });
+   double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+   double inBytes = static_cast<double>(in.size());
+   double outBytes = static_cast<double>(out.size());
+   std::cout << std::fixed << std::setprecision(3)
+             << n << " pairs of " << 8 * sizeof(U) << "-bit values ("
+             << (soa ? "soa" : "aos") << ", kernel " << kernel << ", "
+             << pool.size() << " threads) in " << seconds << " s\n"
+             << "   " << inBytes / 1e9 << " GB in, " << outBytes / 1e9
+             << " GB out: " << (inBytes + outBytes) / 1e9 / seconds
+             << " GB/s, " << n / 1e6 / seconds << " Mpairs/s\n"
+             << std::defaultfloat;
+
+   if (verify) {
+      for (std::size_t i = 0; i < n; ++i) {
+         U g;
+         S x, y;
+         unsigned_extended_euclidean<S, U>(layout.a[i*layout.inStride],
+                                           layout.b[i*layout.inStride],
+                                           &g, &x, &y);
+         std::size_t o = i * layout.outStride;
+         if (g != layout.g[o] || x != layout.x[o] || y != layout.y[o]) {
+            std::cerr << "verification failed at pair " << i << "\n";
+            return 1;
+         }
+      }
+      std::cout << "   verified all results\n";
+   }
+   return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+   stream_format format;
+   std::size_t chunk = 1 << 16;
+   std::size_t generatePairs = 0;
+   bool generating = false;
+   bool verify = false;
+   uint64_t seed = 1;
+   unsigned int numThreads = 0;
+   const char* paths[2] = { nullptr, nullptr };
+   int numPaths = 0;
+   for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+         if (!parse_format(argv[++i], &format)) {
+            std::cout << "invalid format: " << argv[i] << "\n";
+            return 1;
+         }
+      } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+         numThreads = static_cast<unsigned int>(std::atoi(argv[++i]));
+      } else if (std::strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+         chunk = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+      } else if (std::strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+         generating = true;
+         generatePairs = std::strtoull(argv[++i], nullptr, 10);
+      } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+         seed = std::strtoull(argv[++i], nullptr, 10);
+      } else if (std::strcmp(argv[i], "--verify") == 0) {
+         verify = true;
+      } else if (argv[i][0] != '-' && numPaths < 2) {
+         paths[numPaths++] = argv[i];
+      } else {
+         std::cout << "unknown or incomplete option: " << argv[i] << "\n";
+         return 1;
+      }
+   }
+
+   if (generating) {
+      if (numPaths != 1) {
+         std::cout << "--generate needs one output file\n";
+         return 1;
+      }
+      switch (format.width) {
+         case 8:  return generate<uint8_t>(paths[0], generatePairs, seed, format.soa);
+         case 16: return generate<uint16_t>(paths[0], generatePairs, seed, format.soa);
+         case 32: return generate<uint32_t>(paths[0], generatePairs, seed, format.soa);
+         default: return generate<uint64_t>(paths[0], generatePairs, seed, format.soa);
+      }
+   }
+   if (numPaths != 2) {
+      std::cout << "usage: extended_euclidean_stream [--format WIDTH[:aos|:soa]] "
+                   "[--threads N] [--chunk PAIRS] [--verify] INPUT OUTPUT\n";
+      return 1;
+   }
+   switch (format.width) {
+      case 8:  return stream<uint8_t>(paths[0], paths[1], format.soa, chunk, numThreads, verify);
+      case 16: return stream<uint16_t>(paths[0], paths[1], format.soa, chunk, numThreads, verify);
+      case 32: return stream<uint32_t>(paths[0], paths[1], format.soa, chunk, numThreads, verify);
+      default: return stream<uint64_t>(paths[0], paths[1], format.soa, chunk, numThreads, verify);
+   }
+}
@@ -0,0 +1,315 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// A local daemon that serves extended gcd and modular inverse requests over a
+// Unix domain socket, in the framing of inversion_protocol.h.
+//
+// Each connection has a thread that reads request frames and hands them to
+// the batcher.  The batcher coalesces the pairs of concurrent requests into
+// one batch per width, solves it with the dispatched kernel of
+// extended_euclidean_dispatch.h, and hands every request its results.  A
+// batch is started once it holds --max-batch pairs, once its oldest request
+// has waited --max-wait-us, or as soon as every open connection has a request
+// queued (a connection has at most one request outstanding, and the batcher
+// waits only while no batch is being solved, so then no other request can
+// join).  So no request waits longer than --max-wait-us for company.  A
+// request larger than --max-batch is solved as a batch of its own.
+//
+// Usage: inversion_daemon [--socket PATH] [--max-batch PAIRS]
+//                         [--max-wait-us MICROSECONDS]
+// Runs until SIGINT or SIGTERM, then prints batching statistics.
+
+#include "inversion_protocol.h"
+#include "../extended_euclidean_dispatch.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+struct pending_request {
+   frame_header header;
+   std::vector<unsigned char> payload;
+   std::vector<unsigned char> response;
+   std::chrono::steady_clock::time_point arrival;
+   bool done = false;
+};
+
+
+// Solves the requests, all of width digits(U), as one batch.
+template <class U>
+void solve_requests(const std::vector<pending_request*>& requests)
+{
+   using S = typename std::make_signed<U>::type;
+   static thread_local std::vector<U> a, b, g;
+   static thread_local std::vector<S> x, y;
+   std::size_t total = 0;
+   for (const pending_request* r : requests)
+      total += r->header.count;
+   a.resize(total); b.resize(total); g.resize(total);
+   x.resize(total); y.resize(total);
+
+   std::size_t k = 0;
+   for (const pending_request* r : requests) {
+      const unsigned char* in = r->payload.data();
+      for (uint32_t i = 0; i < r->header.count; ++i, ++k) {
+         std::memcpy(&a[k], in + (2*i) * sizeof(U), sizeof(U));
+         std::memcpy(&b[k], in + (2*i + 1) * sizeof(U), sizeof(U));
+      }
+   }
+   dispatched_extended_euclidean<S, U>(a.data(), b.data(), total,
+                                       g.data(), x.data(), y.data());
+   k = 0;
+   for (pending_request* r : requests) {
+      r->response.resize(response_payload_size(r->header));
+      unsigned char* out = r->response.data();
+      for (uint32_t i = 0; i < r->header.count; ++i, ++k) {
+         if (r->header.op == OP_EXTENDED_GCD) {
+            std::memcpy(out + (3*i) * sizeof(U), &g[k], sizeof(U));
+            std::memcpy(out + (3*i + 1) * sizeof(U), &x[k], sizeof(S));
+            std::memcpy(out + (3*i + 2) * sizeof(U), &y[k], sizeof(S));
+         } else {
+            // a*x == 1 (mod m), with |x| <= m/2
+            U m = b[k];
+            U inverse = 0;
+            if (g[k] == 1 && m != 0)
+               inverse = (x[k] < 0) ? static_cast<U>(static_cast<U>(x[k]) + m)
+                                    : static_cast<U>(x[k]);
+            std::memcpy(out + (2*i) * sizeof(U), &g[k], sizeof(U));
+            std::memcpy(out + (2*i + 1) * sizeof(U), &inverse, sizeof(U));
+         }
+      }
+   }
+}
+
+
+class request_batcher {
+   std::mutex mutex;
+   std::condition_variable queued, completed;
+   std::deque<pending_request*> queue;
+   std::size_t queuedPairs = 0;
+   std::size_t numConnections = 0;
+   bool stopping = false;
+   const std::size_t maxBatch;
+   const std::chrono::microseconds maxWait;
+   std::thread thread;
+
+   // statistics, guarded by mutex
+   uint64_t numRequests = 0, numPairs = 0, numBatches = 0;
+
+   void run()
+   {
+      std::vector<pending_request*> batch;
+      std::vector<pending_request*> byWidth[4];
+      for (;;) {
+         {
+            std::unique_lock<std::mutex> lock(mutex);
+            queued.wait(lock, [&]() { return stopping || !queue.empty(); });
+            if (stopping)
+               return;
+            auto deadline = queue.front()->arrival + maxWait;
+            queued.wait_until(lock, deadline, [&]() {
+                  return stopping || queuedPairs >= maxBatch ||
+                         queue.size() >= numConnections; });
+            if (stopping)
+               return;
+            std::size_t pairs = 0;
+            batch.clear();
+            while (!queue.empty() && (batch.empty() ||
+                           pairs + queue.front()->header.count <= maxBatch)) {
+               pairs += queue.front()->header.count;
+               batch.push_back(queue.front());
+               queue.pop_front();
+            }
+            queuedPairs -= pairs;
+            numRequests += batch.size();
+            numPairs += pairs;
+            ++numBatches;
+         }
+
+         for (auto& requests : byWidth)
+            requests.clear();
+         for (pending_request* r : batch) {
+            int index = (r->header.width == 8) ? 0 : (r->header.width == 16) ? 1
+                      : (r->header.width == 32) ? 2 : 3;
+            byWidth[index].push_back(r);
+         }
+         if (!byWidth[0].empty()) solve_requests<uint8_t>(byWidth[0]);
+         if (!byWidth[1].empty()) solve_requests<uint16_t>(byWidth[1]);
+         if (!byWidth[2].empty()) solve_requests<uint32_t>(byWidth[2]);
+         if (!byWidth[3].empty()) solve_requests<uint64_t>(byWidth[3]);
+
+         {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (pending_request* r : batch)
+               r->done = true;
+         }
+         completed.notify_all();
+      }
+   }
+
+public:
+   request_batcher(std::size_t maxBatch, std::chrono::microseconds maxWait)
+      : maxBatch(maxBatch), maxWait(maxWait)
+   {
+      thread = std::thread(&request_batcher::run, this);
+   }
+
+   ~request_batcher()
+   {
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         stopping = true;
+      }
+      queued.notify_all();
+      thread.join();
+   }
+
+   void connection_opened()
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++numConnections;
+   }
+
+   void connection_closed()
+   {
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         --numConnections;
+      }
+      queued.notify_one();   // the queued requests may now be all there are
+   }
+
+   // queues the request and returns once its response is filled in
+   void solve(pending_request* r)
+   {
+      std::unique_lock<std::mutex> lock(mutex);
+      r->arrival = std::chrono::steady_clock::now();
+      queue.push_back(r);
+      queuedPairs += r->header.count;
+      queued.notify_one();
+      completed.wait(lock, [&]() { return r->done; });
+   }
+
+   void print_statistics()
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      std::cout << numRequests << " requests, " << numPairs << " pairs in "
+                << numBatches << " batches ("
+                << (numBatches ? double(numRequests) / numBatches : 0.0)
+                << " requests, "
+                << (numBatches ? double(numPairs) / numBatches : 0.0)
+                << " pairs per batch)\n";
+   }
+};
+
+
+void serve_connection(int fd, request_batcher* pBatcher)
+{
+   pBatcher->connection_opened();
+   for (;;) {
+      pending_request request;
+      if (!read_full(fd, &request.header, sizeof(request.header)))
+         break;
+      if (!valid_request(request.header)) {
+         request.header.status = STATUS_BAD_REQUEST;
+         write_full(fd, &request.header, sizeof(request.header));
+         break;
+      }
+      request.payload.resize(request_payload_size(request.header));
+      if (!read_full(fd, request.payload.data(), request.payload.size()))
+         break;
+      pBatcher->solve(&request);
+      request.header.status = STATUS_OK;
+      if (!write_full(fd, &request.header, sizeof(request.header)) ||
+              !write_full(fd, request.response.data(), request.response.size()))
+         break;
+   }
+   pBatcher->connection_closed();
+   close(fd);
+}
+
+
+std::atomic<bool> g_stop(false);
+
+void request_stop(int)
+{
+   g_stop = true;
+}
+
+
+int main(int argc, char *argv[])
+{
+   const char* path = INVERSION_DEFAULT_SOCKET;
+   std::size_t maxBatch = 4096;
+   long maxWaitUs = 100;
+   for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+         path = argv[++i];
+      } else if (std::strcmp(argv[i], "--max-batch") == 0 && i + 1 < argc) {
+         maxBatch = std::strtoull(argv[++i], nullptr, 10);
+      } else if (std::strcmp(argv[i], "--max-wait-us") == 0 && i + 1 < argc) {
+         maxWaitUs = std::atol(argv[++i]);
+      } else {
+         std::cout << "unknown or incomplete option: " << argv[i] << "\n";
+         return 1;
+      }
+   }
+
+   sockaddr_un address = {};
+   address.sun_family = AF_UNIX;
+   if (std::strlen(path) >= sizeof(address.sun_path)) {
+      std::cout << "socket path too long: " << path << "\n";
+      return 1;
+   }
+   std::strcpy(address.sun_path, path);
+   int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+   unlink(path);
+   if (listener < 0 ||
+           bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+           listen(listener, 128) != 0) {
+      std::cout << "cannot listen on " << path << ": " << std::strerror(errno) << "\n";
+      return 1;
+   }
+
+   signal(SIGPIPE, SIG_IGN);
+   signal(SIGINT, request_stop);
+   signal(SIGTERM, request_stop);
+   init_extended_euclidean_dispatch();
+   std::cout << "serving on " << path << " (kernels: "
+             << dispatched_kernel<int32_t, uint32_t>().name << " for 32 bits, "
+             << dispatched_kernel<int64_t, uint64_t>().name << " for 64 bits; "
+             << "max batch " << maxBatch << " pairs, max wait " << maxWaitUs
+             << " us)\n" << std::flush;
+
+   // never destroyed, as connection threads may still be waiting on it when
+   // the daemon exits
+   request_batcher* batcher =
+         new request_batcher(maxBatch, std::chrono::microseconds(maxWaitUs));
+   while (!g_stop) {
+      pollfd p = { listener, POLLIN, 0 };
+      if (poll(&p, 1, 200) <= 0)
+         continue;
+      int fd = accept(listener, nullptr, nullptr);
+      if (fd >= 0)
+         std::thread(serve_connection, fd, batcher).detach();
+   }
+   close(listener);
+   unlink(path);
+   batcher->print_statistics();
+   return 0;
+}
@@ -0,0 +1,242 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// A load generator for inversion_daemon.  Each of --connections threads opens
+// its own connection and sends requests of --batch random pairs back to back
+// for --seconds, timing every round trip.  Reports the latency percentiles
+// over all requests, and the throughput.  With --verify, checks every result
+// against unsigned_extended_euclidean().
+//
+// Usage: inversion_load [--socket PATH] [--connections N] [--seconds T]
+//                       [--batch PAIRS] [--width 8|16|32|64]
+//                       [--op gcd|inverse] [--verify]
+
+#include "inversion_protocol.h"
+#include "../fast_prng.h"
+#include "../unsigned_extended_euclidean.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+struct load_options {
+   const char* path = INVERSION_DEFAULT_SOCKET;
+   unsigned int connections = 4;
+   double seconds = 5;
+   uint32_t batch = 64;
+   int width = 64;
+   inversion_op op = OP_EXTENDED_GCD;
+   bool verify = false;
+};
+
+
+int connect_to(const char* path)
+{
+   sockaddr_un address = {};
+   address.sun_family = AF_UNIX;
+   std::strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd >= 0 &&
+           connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+      close(fd);
+      fd = -1;
+   }
+   return fd;
+}
+
+
+// checks one result of the response against unsigned_extended_euclidean()
+template <class U>
+bool check_result(inversion_op op, const unsigned char* request,
+                  const unsigned char* response, uint32_t i)
+{
+   using S = typename std::make_signed<U>::type;
+   U a, b, g;
+   S x, y;
+   std::memcpy(&a, request + (2*i) * sizeof(U), sizeof(U));
+   std::memcpy(&b, request + (2*i + 1) * sizeof(U), sizeof(U));
+   unsigned_extended_euclidean<S, U>(a, b, &g, &x, &y);
+   if (op == OP_EXTENDED_GCD) {
+      U g2;
+      S x2, y2;
+      std::memcpy(&g2, response + (3*i) * sizeof(U), sizeof(U));
+      std::memcpy(&x2, response + (3*i + 1) * sizeof(U), sizeof(S));
+      std::memcpy(&y2, response + (3*i + 2) * sizeof(U), sizeof(S));
+      return g == g2 && x == x2 && y == y2;
+   }
+   U g2, inverse;
+   std::memcpy(&g2, response + (2*i) * sizeof(U), sizeof(U));
+   std::memcpy(&inverse, response + (2*i + 1) * sizeof(U), sizeof(U));
+   if (g != g2)
+      return false;
+   if (g != 1 || b == 0)
+      return inverse == 0;
+   U expected = (x < 0) ? static_cast<U>(static_cast<U>(x) + b)
+                        : static_cast<U>(x);
+   return inverse == expected;
+}
+
+
+// Runs one connection until the deadline; appends its round trip latencies
+// in ns to pLatencies.  Returns false on a connection or verification error.
+bool run_connection(const load_options& options, uint64_t seed,
+                    std::chrono::steady_clock::time_point deadline,
+                    std::vector<double>* pLatencies)
+{
+   using clock = std::chrono::steady_clock;
+   int fd = connect_to(options.path);
+   if (fd < 0) {
+      std::cout << "cannot connect to " << options.path << "\n";
+      return false;
+   }
+   frame_header request = {};
+   request.magic = INVERSION_MAGIC;
+   request.width = static_cast<uint8_t>(options.width);
+   request.op = options.op;
+   request.count = options.batch;
+   std::vector<unsigned char> payload(request_payload_size(request));
+   std::vector<unsigned char> response(response_payload_size(request));
+   const std::size_t bytes = options.width / 8;
+   xoshiro256ss random(seed);
+
+   bool ok = true;
+   while (ok && clock::now() < deadline) {
+      for (std::size_t i = 0; i < payload.size(); i += bytes) {
+         uint64_t value = random.next();
+         std::memcpy(&payload[i], &value, bytes);   // the low bytes
+      }
+      ++request.id;
+      auto start = clock::now();
+      frame_header reply;
+      ok = write_full(fd, &request, sizeof(request)) &&
+           write_full(fd, payload.data(), payload.size()) &&
+           read_full(fd, &reply, sizeof(reply)) &&
+           reply.status == STATUS_OK && reply.id == request.id &&
+           read_full(fd, response.data(), response.size());
+      auto end = clock::now();
+      if (!ok) {
+         std::cout << "request failed\n";
+         break;
+      }
+      pLatencies->push_back(std::chrono::duration<double, std::nano>(end - start).count());
+      for (uint32_t i = 0; options.verify && i < request.count; ++i) {
+         bool match =
+            (options.width == 8)  ? check_result<uint8_t>(options.op, payload.data(), response.data(), i) :
+            (options.width == 16) ? check_result<uint16_t>(options.op, payload.data(), response.data(), i) :
+            (options.width == 32) ? check_result<uint32_t>(options.op, payload.data(), response.data(), i) :
+                                    check_result<uint64_t>(options.op, payload.data(), response.data(), i);
+         if (!match) {
+            std::cout << "verification failed (request " << request.id
+                      << ", pair " << i << ")\n";
+            ok = false;
+            break;
+         }
+      }
+   }
+   close(fd);
+   return ok;
+}
+
+
+double percentile(const std::vector<double>& sorted, double p)
+{
+   if (sorted.empty())
+      return 0;
+   std::size_t index = static_cast<std::size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+   return sorted[index];
+}
+
+
+int main(int argc, char *argv[])
+{
+   load_options options;
+   for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+         options.path = argv[++i];
+      } else if (std::strcmp(argv[i], "--connections") == 0 && i + 1 < argc) {
+         options.connections = std::max(1, std::atoi(argv[++i]));
+      } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+         options.seconds = std::atof(argv[++i]);
+      } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+         options.batch = static_cast<uint32_t>(std::atoi(argv[++i]));
+      } else if (std::strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+         options.width = std::atoi(argv[++i]);
+      } else if (std::strcmp(argv[i], "--op") == 0 && i + 1 < argc) {
+         ++i;
+         if (std::strcmp(argv[i], "gcd") == 0)
+            options.op = OP_EXTENDED_GCD;
+         else if (std::strcmp(argv[i], "inverse") == 0)
+            options.op = OP_INVERSE;
+         else {
+            std::cout << "unknown op: " << argv[i] << "\n";
+            return 1;
+         }
+      } else if (std::strcmp(argv[i], "--verify") == 0) {
+         options.verify = true;
+      } else {
+         std::cout << "unknown or incomplete option: " << argv[i] << "\n";
+         return 1;
+      }
+   }
+   frame_header check = { INVERSION_MAGIC, static_cast<uint8_t>(options.width),
+                          options.op, 0, 0, options.batch, 0, 0 };
+   if (!valid_request(check) || options.width != check.width) {
+      std::cout << "invalid --width or --batch\n";
+      return 1;
+   }
+
+   std::cout << "***Inversion Daemon Load Test***\n\n"
+             << options.connections << " connections, " << options.batch
+             << " pairs of " << options.width << " bits per request, "
+             << (options.op == OP_EXTENDED_GCD ? "extended gcd" : "inverse")
+             << "\n";
+   auto start = std::chrono::steady_clock::now();
+   auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                 std::chrono::duration<double>(options.seconds));
+   std::vector<std::vector<double>> latencies(options.connections);
+   std::atomic<bool> allOk(true);
+   std::vector<std::thread> threads;
+   for (unsigned int c = 0; c < options.connections; ++c) {
+      threads.emplace_back([&, c]() {
+            if (!run_connection(options, c + 1, deadline, &latencies[c]))
+               allOk = false;
+         });
+   }
+   for (auto& thread : threads)
+      thread.join();
+   double elapsed = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start).count();
+
+   std::vector<double> all;
+   for (const auto& l : latencies)
+      all.insert(all.end(), l.begin(), l.end());
+   std::sort(all.begin(), all.end());
+   std::cout << std::fixed << std::setprecision(1)
+             << all.size() << " requests in " << elapsed << " s: "
+             << all.size() / elapsed << " requests/s, "
+             << all.size() * double(options.batch) / elapsed / 1e6
+             << " Mpairs/s\n"
+             << "latency us: p50 " << percentile(all, 50) / 1000
+             << ", p90 " << percentile(all, 90) / 1000
+             << ", p99 " << percentile(all, 99) / 1000
+             << ", max " << (all.empty() ? 0 : all.back() / 1000) << "\n"
+             << std::defaultfloat;
+   if (!allOk)
+      return 1;
+   if (options.verify)
+      std::cout << "verified all results\n";
+   return 0;
+}
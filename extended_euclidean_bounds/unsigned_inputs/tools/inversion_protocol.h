@@ -0,0 +1,108 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// The binary framing spoken over the Unix domain socket by inversion_daemon
+// and its clients.  Every message is a frame_header followed by a payload of
+// packed values in native byte order, all of the width given in the header:
+//
+//   request   OP_EXTENDED_GCD   count x (a, b)
+//             OP_INVERSE        count x (a, m)
+//   response  OP_EXTENDED_GCD   count x (gcd, x, y)   as unsigned_extended_euclidean()
+//             OP_INVERSE        count x (gcd, inverse)
+//
+// For OP_INVERSE, the inverse of a modulo m exists iff gcd == 1 and m != 0,
+// and is then the value in [0, m) with a*inverse == 1 (mod m); otherwise the
+// inverse field is 0.  A response echoes the request's header with status
+// set; a response with status STATUS_BAD_REQUEST has no payload, and the
+// daemon closes the connection after sending it.
+
+#ifndef INVERSION_PROTOCOL
+#define INVERSION_PROTOCOL 1
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <unistd.h>
+
+
+const uint32_t INVERSION_MAGIC = 0x45474344;     // "DCGE"
+const uint32_t INVERSION_MAX_COUNT = 1u << 20;   // pairs per frame
+const char* const INVERSION_DEFAULT_SOCKET = "/tmp/extended_euclidean.sock";
+
+enum inversion_op : uint8_t {
+   OP_EXTENDED_GCD = 0,
+   OP_INVERSE = 1
+};
+
+enum inversion_status : uint8_t {
+   STATUS_OK = 0,
+   STATUS_BAD_REQUEST = 1
+};
+
+struct frame_header {
+   uint32_t magic;
+   uint8_t width;      // 8, 16, 32 or 64
+   uint8_t op;         // an inversion_op
+   uint8_t status;     // an inversion_status; 0 in requests
+   uint8_t reserved;
+   uint32_t count;     // number of pairs
+   uint32_t reserved2;
+   uint64_t id;        // chosen by the client, echoed in the response
+};
+static_assert(sizeof(frame_header) == 24, "");
+
+
+inline bool valid_request(const frame_header& header)
+{
+   return header.magic == INVERSION_MAGIC &&
+          (header.width == 8 || header.width == 16 ||
+           header.width == 32 || header.width == 64) &&
+          (header.op == OP_EXTENDED_GCD || header.op == OP_INVERSE) &&
+          header.count <= INVERSION_MAX_COUNT;
+}
+
+inline std::size_t request_payload_size(const frame_header& header)
+{
+   return std::size_t(header.count) * 2 * (header.width / 8);
+}
+
+inline std::size_t response_payload_size(const frame_header& header)
+{
+   int valuesPerPair = (header.op == OP_EXTENDED_GCD) ? 3 : 2;
+   return std::size_t(header.count) * valuesPerPair * (header.width / 8);
+}
+
+
+// Reads or writes exactly 'size' bytes, retrying after partial transfers and
+// interruptions.  Return false on error or end of file.
+inline bool read_full(int fd, void* data, std::size_t size)
+{
+   unsigned char* p = static_cast<unsigned char*>(data);
+   while (size > 0) {
+      ssize_t got = read(fd, p, size);
+      if (got < 0 && errno == EINTR)
+         continue;
+      if (got <= 0)
+         return false;
+      p += got;
+      size -= static_cast<std::size_t>(got);
+   }
+   return true;
+}
+
+inline bool write_full(int fd, const void* data, std::size_t size)
+{
+   const unsigned char* p = static_cast<const unsigned char*>(data);
+   while (size > 0) {
+      ssize_t put = write(fd, p, size);
+      if (put < 0 && errno == EINTR)
+         continue;
+      if (put <= 0)
+         return false;
+      p += put;
+      size -= static_cast<std::size_t>(put);
+   }
+   return true;
+}
+
+#endif
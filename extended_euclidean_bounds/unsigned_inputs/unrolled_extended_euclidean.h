@@ -0,0 +1,67 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// unsigned_extended_euclidean() unrolled STEPS quotient steps at a time.  The
+// plain loop updates x and y on every step, each update depending on the
+// previous one; here the steps of a block accumulate in a 2x2 matrix M, which
+// depends only on the quotients, and x and y are updated once per block:
+//
+//    (x0, x1) <- (M00*x0 + M01*x1, M10*x0 + M11*x1), and likewise for y.
+//
+// The four products of an update are independent of each other, so the
+// dependency chain through x and y is shorter and the compiler has more
+// independent work to schedule.  A block ends early on a zero remainder.
+//
+// The matrix entries and products may exceed S, so they're computed in
+// wrapping unsigned arithmetic; the coefficients they produce are Euclidean
+// coefficients, which fit S by the final bounds, so the results are exact.
+// For all inputs the results are identical to those of
+// unsigned_extended_euclidean().
+
+#ifndef UNROLLED_EXTENDED_EUCLIDEAN
+#define UNROLLED_EXTENDED_EUCLIDEAN 1
+
+#include <limits>
+#include <type_traits>
+
+
+template <int STEPS, class S, class U>
+void unrolled_extended_euclidean(const U a, const U b, U* pGcd, S* pX, S* pY)
+{
+   static_assert(STEPS >= 1, "");
+   static_assert(std::numeric_limits<S>::is_integer, "");
+   static_assert(std::numeric_limits<S>::is_signed, "");
+   static_assert(std::numeric_limits<U>::is_integer, "");
+   static_assert(!(std::numeric_limits<U>::is_signed), "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
+   using P = typename std::common_type<U, unsigned int>::type;   // no int promotion
+   P x0=1, y0=0;
+   P x1=0, y1=1;
+   U a0=a, a1=b;
+
+   while (a1 != 0) {
+      P m00=1, m01=0;
+      P m10=0, m11=1;
+      for (int i = 0; i < STEPS; ++i) {
+         U q = static_cast<U>(a0/a1);
+         U a2 = static_cast<U>(a0 - q*a1);
+         P t0 = m00 - q*m10;
+         P t1 = m01 - q*m11;
+         m00=m10; m01=m11; a0=a1;
+         m10=t0;  m11=t1;  a1=a2;
+         if (a1 == 0)
+            break;
+      }
+      P x2 = m00*x0 + m01*x1;
+      P x3 = m10*x0 + m11*x1;
+      P y2 = m00*y0 + m01*y1;
+      P y3 = m10*y0 + m11*y1;
+      x0=x2; y0=y2;
+      x1=x3; y1=y3;
+   }
+   *pX = static_cast<S>(static_cast<U>(x0));
+   *pY = static_cast<S>(static_cast<U>(y0));
+   *pGcd = a0;
+}
+
+#endif
@@ -15,7 +15,7 @@ void unsigned_extended_euclidean(const U a, const U b, U* pGcd, S* pX, S* pY)
    static_assert(std::numeric_limits<S>::is_signed, "");
    static_assert(std::numeric_limits<U>::is_integer, "");
    static_assert(!(std::numeric_limits<U>::is_signed), "");
-   static_assert(std::is_same<std::make_signed<U>::type, S>::value, "");
+   static_assert(std::is_same<typename std::make_signed<U>::type, S>::value, "");
    S x1=1, y1=0;
    U a1=a;
    S x0=0, y0=1;
@@ -0,0 +1,53 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// wide_multiply(a, b, &low), the double width product of two N bit unsigned
+// values, for N of 8 to 128 bits: uint64_t up to 32 bits, unsigned __int128
+// at 64 bits (or without it, four 32-bit products), and four 64-bit products
+// at 128 bits.
+
+#ifndef WIDE_MULTIPLY
+#define WIDE_MULTIPLY 1
+
+#include <cstdint>
+#include <limits>
+
+
+// The double width product a*b: returns its high N bits, with its low N bits
+// in *pLow.
+template <class U>
+U wide_multiply(const U a, const U b, U* pLow)
+{
+   constexpr int N = std::numeric_limits<U>::digits;
+   if constexpr (N <= 32) {
+      uint64_t t = static_cast<uint64_t>(a) * b;
+      *pLow = static_cast<U>(t);
+      return static_cast<U>(t >> N);
+   } else if constexpr (N == 64) {
+#ifdef __SIZEOF_INT128__
+      unsigned __int128 t = static_cast<unsigned __int128>(a) * b;
+      *pLow = static_cast<U>(t);
+      return static_cast<U>(t >> 64);
+#else
+      const uint64_t a0 = a & 0xffffffffu, a1 = a >> 32;
+      const uint64_t b0 = b & 0xffffffffu, b1 = b >> 32;
+      uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+      // at most 3*(2^32 - 1), so it doesn't wrap
+      uint64_t middle = (p00 >> 32) + (p01 & 0xffffffffu) + (p10 & 0xffffffffu);
+      *pLow = (middle << 32) | (p00 & 0xffffffffu);
+      return p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+#endif
+   } else {
+      static_assert(N == 128, "");
+      const uint64_t a0 = static_cast<uint64_t>(a), a1 = static_cast<uint64_t>(a >> 64);
+      const uint64_t b0 = static_cast<uint64_t>(b), b1 = static_cast<uint64_t>(b >> 64);
+      U p00 = static_cast<U>(a0) * b0, p01 = static_cast<U>(a0) * b1;
+      U p10 = static_cast<U>(a1) * b0, p11 = static_cast<U>(a1) * b1;
+      // at most 3*(2^64 - 1), so it doesn't wrap
+      U middle = (p00 >> 64) + static_cast<uint64_t>(p01) + static_cast<uint64_t>(p10);
+      *pLow = (middle << 64) | static_cast<uint64_t>(p00);
+      return p11 + (p01 >> 64) + (p10 >> 64) + (middle >> 64);
+   }
+}
+
+#endif
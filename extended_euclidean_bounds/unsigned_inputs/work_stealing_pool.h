@@ -0,0 +1,196 @@
+// --- This file is distributed under the MIT Open Source License, as detailed
+// in the file "LICENSE.TXT" in the root of this repository ---
+
+// A persistent thread pool whose parallel_for() balances tasks by work
+// stealing.  Each call of parallel_for(numTasks, task) splits the task indices
+// [0, numTasks) into one contiguous range per thread.  A thread takes tasks
+// one at a time from the front of its own range, and when its range is empty
+// it steals the back half of the largest remaining range of another thread.
+// Ranges are only touched by their owner except during a steal, so the locks
+// are almost never contended, and each thread works on contiguous indices.
+//
+// The thread that calls parallel_for() takes part as thread 0, so a pool of
+// size N starts N-1 background threads.  Calls of parallel_for() on the same
+// pool are serialized.
+
+#ifndef WORK_STEALING_POOL
+#define WORK_STEALING_POOL 1
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+class work_stealing_pool {
+   // one per thread, on its own cache line so that the owners' updates don't
+   // falsely share
+   struct alignas(64) task_range {
+      std::mutex mutex;
+      std::size_t begin = 0, end = 0;
+   };
+
+   std::vector<std::thread> threads;
+   std::unique_ptr<task_range[]> ranges;
+   unsigned int numThreads;
+
+   std::mutex submitMutex;           // serializes calls of parallel_for()
+   std::mutex jobMutex;
+   std::condition_variable jobStarted, jobFinished;
+   uint64_t jobGeneration = 0;
+   unsigned int threadsWorking = 0;
+   bool shuttingDown = false;
+   const std::function<void(std::size_t)>* job = nullptr;
+
+   bool take_own_task(unsigned int self, std::size_t* pTask)
+   {
+      task_range& r = ranges[self];
+      std::lock_guard<std::mutex> lock(r.mutex);
+      if (r.begin == r.end)
+         return false;
+      *pTask = r.begin++;
+      return true;
+   }
+
+   // moves the back half of the largest other range into the range of self
+   bool steal(unsigned int self)
+   {
+      for (;;) {
+         unsigned int victim = self;
+         std::size_t largest = 0;
+         for (unsigned int t = 0; t < numThreads; ++t) {
+            if (t == self)
+               continue;
+            std::lock_guard<std::mutex> lock(ranges[t].mutex);
+            std::size_t size = ranges[t].end - ranges[t].begin;
+            if (size > largest) {
+               largest = size;
+               victim = t;
+            }
+         }
+         if (victim == self)
+            return false;
+         std::size_t begin, end;
+         {
+            std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+            task_range& v = ranges[victim];
+            std::size_t size = v.end - v.begin;
+            if (size == 0)
+               continue;    // the victim finished meanwhile; look again
+            end = v.end;
+            begin = v.end - (size + 1) / 2;
+            v.end = begin;
+         }
+         std::lock_guard<std::mutex> lock(ranges[self].mutex);
+         ranges[self].begin = begin;
+         ranges[self].end = end;
+         return true;
+      }
+   }
+
+   void work(unsigned int self, const std::function<void(std::size_t)>& task)
+   {
+      std::size_t index;
+      for (;;) {
+         while (take_own_task(self, &index))
+            task(index);
+         if (!steal(self))
+            return;
+      }
+   }
+
+   void worker_loop(unsigned int self)
+   {
+      uint64_t seenGeneration = 0;
+      for (;;) {
+         const std::function<void(std::size_t)>* currentJob;
+         {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobStarted.wait(lock, [&]() {
+                  return shuttingDown || jobGeneration != seenGeneration; });
+            if (shuttingDown)
+               return;
+            seenGeneration = jobGeneration;
+            currentJob = job;
+         }
+         work(self, *currentJob);
+         std::lock_guard<std::mutex> lock(jobMutex);
+         if (--threadsWorking == 0)
+            jobFinished.notify_all();
+      }
+   }
+
+public:
+   // numThreads == 0 uses one thread per hardware thread
+   explicit work_stealing_pool(unsigned int numThreads = 0)
+   {
+      if (numThreads == 0)
+         numThreads = std::max(1u, std::thread::hardware_concurrency());
+      this->numThreads = numThreads;
+      ranges.reset(new task_range[numThreads]);
+      for (unsigned int t = 1; t < numThreads; ++t)
+         threads.emplace_back(&work_stealing_pool::worker_loop, this, t);
+   }
+
+   ~work_stealing_pool()
+   {
+      {
+         std::lock_guard<std::mutex> lock(jobMutex);
+         shuttingDown = true;
+      }
+      jobStarted.notify_all();
+      for (auto& thread : threads)
+         thread.join();
+   }
+
+   work_stealing_pool(const work_stealing_pool&) = delete;
+   work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+   unsigned int size() const { return numThreads; }
+
+   // Calls task(i) once for every i in [0, numTasks), and returns when all
+   // calls have completed.
+   void parallel_for(std::size_t numTasks,
+                     const std::function<void(std::size_t)>& task)
+   {
+      if (numTasks == 0)
+         return;
+      std::lock_guard<std::mutex> submitLock(submitMutex);
+      if (numThreads == 1 || numTasks == 1) {
+         for (std::size_t i = 0; i < numTasks; ++i)
+            task(i);
+         return;
+      }
+      for (unsigned int t = 0; t < numThreads; ++t) {
+         std::lock_guard<std::mutex> lock(ranges[t].mutex);
+         ranges[t].begin = numTasks * t / numThreads;
+         ranges[t].end = numTasks * (t + 1) / numThreads;
+      }
+      {
+         std::lock_guard<std::mutex> lock(jobMutex);
+         job = &task;
+         threadsWorking = numThreads - 1;
+         ++jobGeneration;
+      }
+      jobStarted.notify_all();
+      work(0, task);
+      std::unique_lock<std::mutex> lock(jobMutex);
+      jobFinished.wait(lock, [&]() { return threadsWorking == 0; });
+      job = nullptr;
+   }
+
+   // a pool with one thread per hardware thread, created on first use
+   static work_stealing_pool& default_instance()
+   {
+      static work_stealing_pool pool;
+      return pool;
+   }
+};
+
+#endif